@@ -0,0 +1,65 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "analysis.h"
+#include "solver.h"
+
+/**
+   Compares each guess made in a game with the best guess available at
+   that point. Every word in the dictionary is considered a possible
+   answer before the first guess.
+
+   @param game the game to be analyzed. May be finished or not.
+
+   @param analysis an array where the analysis of each guess is
+   stored. Must have space for MAX_NUM_ATTEMPTS elements; only the
+   first `game->num_attempts` are set.
+
+   @returns a non-zero value if the game was analyzed, or zero if
+   memory could not be allocated.
+ */
+int analyze_game(const yk_game_t *game, guess_analysis_t analysis[]) {
+  return analyze_game_book(game, NULL, analysis);
+}
+
+/**
+   Same as `analyze_game`, but takes the best first and second guesses
+   from an opening book instead of searching for them.
+
+   @param book the opening book of the game's dictionary, or NULL.
+ */
+int analyze_game_book(const yk_game_t *game, const opening_book_t *book, guess_analysis_t analysis[]) {
+  const yk_dict_t *dict = game->dict;
+  unsigned int num_candidates = dict->num_words;
+
+  packed_word_t *candidates = malloc((num_candidates ? num_candidates : 1) * sizeof(*candidates));
+  if (candidates == NULL) return 0;
+  memcpy(candidates, dict->words, num_candidates * sizeof(*candidates));
+
+  for (unsigned int i = 0; i < game->num_attempts; i++) {
+    guess_analysis_t *entry = &analysis[i];
+
+    entry->guess = pack_word(game->guesses[i]);
+    entry->pattern = pattern_from_result(game->results[i]);
+    entry->candidates_before = num_candidates;
+    entry->expected_bits = guess_entropy(entry->guess, candidates, num_candidates);
+    entry->best_guess = opening_book_guess(book, i, analysis[0].guess, analysis[0].pattern);
+    if (entry->best_guess != 0)
+      entry->best_expected_bits = guess_entropy(entry->best_guess, candidates, num_candidates);
+    else
+      entry->best_guess = best_guess(dict->words, dict->num_words, candidates, num_candidates,
+                                     &entry->best_expected_bits);
+    if (entry->best_guess == 0) {
+      free(candidates);
+      return 0;
+    }
+
+    num_candidates = filter_candidates(candidates, num_candidates, entry->guess, entry->pattern, candidates);
+    entry->candidates_after = num_candidates;
+    entry->bits_gained = num_candidates > 0 ? log2((double) entry->candidates_before / num_candidates) : 0;
+  }
+
+  free(candidates);
+  return 1;
+}
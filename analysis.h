@@ -0,0 +1,31 @@
+#pragma once
+
+#include "engine.h"
+#include "book.h"
+
+typedef struct guess_analysis {
+
+  /** The guess made by the player, and the feedback received. */
+  packed_word_t guess;
+  pattern_t pattern;
+
+  /** Number of words that could still be the answer before and after
+      the guess. */
+  unsigned int candidates_before;
+  unsigned int candidates_after;
+
+  /** Information actually gained by the guess, in bits. */
+  double bits_gained;
+
+  /** Information the guess was expected to give, in bits, before its
+      feedback was known. */
+  double expected_bits;
+
+  /** The guess expected to give the most information at that point,
+      and how much it was expected to give. */
+  packed_word_t best_guess;
+  double best_expected_bits;
+} guess_analysis_t;
+
+int analyze_game(const yk_game_t *, guess_analysis_t[]);
+int analyze_game_book(const yk_game_t *, const opening_book_t *, guess_analysis_t[]);
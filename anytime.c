@@ -0,0 +1,105 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+
+#include "anytime.h"
+#include "solver.h"
+#include "lookahead.h"
+
+static double seconds_since(const struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+   Finds a guess within a time budget, refining it for as long as the
+   budget allows. The guess starts as a fallback that costs nothing to
+   find. Then the guess of `best_guess` is found, then the one of
+   `lookahead_guess` for an evenly spaced sample of ANYTIME_SAMPLE_SIZE
+   candidates, then the one of `lookahead_guess` for all candidates, if
+   there are no more than LOOKAHEAD_MAX_CANDIDATES; each stage that
+   finishes before the deadline replaces the guess of the previous
+   one. A stage still running at the deadline, including the first, is
+   stopped shortly after it.
+
+   On a single core, the first stage takes about 20 ms for a hundred
+   candidates and 150 ms for thousands, against the default word list.
+   With a smaller budget, the fallback is returned; callers that have a
+   better one at hand, such as the first guess of an opening book,
+   should pass it.
+
+   @param guesses the words that may be guessed.
+
+   @param num_guesses the number of items in `guesses`.
+
+   @param candidates the words that may still be the answer.
+
+   @param num_candidates the number of items in `candidates`.
+
+   @param budget the time allowed, in seconds.
+
+   @param fallback the guess to return if no stage finishes in time,
+   or zero to return the first candidate.
+
+   @param result where the guess, the last stage that finished and the
+   time spent are stored.
+
+   @returns a non-zero value on success, or zero if there are no
+   guesses or candidates (errno is set to EINVAL).
+ */
+int anytime_guess(const packed_word_t guesses[], unsigned int num_guesses,
+                  const packed_word_t candidates[], unsigned int num_candidates, double budget,
+                  packed_word_t fallback, anytime_result_t *result) {
+  struct timespec start, deadline;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  result->guess = 0;
+  result->stage = ANYTIME_FALLBACK;
+  result->seconds = 0;
+  if (num_guesses == 0 || num_candidates == 0) {
+    errno = EINVAL;
+    return 0;
+  }
+
+  if (budget < 0) budget = 0;
+  deadline.tv_sec = start.tv_sec + (time_t) budget;
+  deadline.tv_nsec = start.tv_nsec + (long) ((budget - (time_t) budget) * 1e9);
+  if (deadline.tv_nsec >= 1000000000) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000;
+  }
+
+  /* Refinement stops at the deadline or at the first stage that fails
+     for any other reason; either way, the last guess found stands. */
+  result->guess = fallback != 0 ? fallback : candidates[0];
+  packed_word_t greedy = best_guess_until(guesses, num_guesses, candidates, num_candidates, &deadline, NULL);
+  if (greedy == 0) goto done;
+  result->guess = greedy;
+  result->stage = ANYTIME_GREEDY;
+
+  if (num_candidates > ANYTIME_SAMPLE_SIZE) {
+    packed_word_t *sample = malloc(ANYTIME_SAMPLE_SIZE * sizeof(*sample));
+    if (sample == NULL) goto done;
+
+    for (unsigned int i = 0; i < ANYTIME_SAMPLE_SIZE; i++)
+      sample[i] = candidates[(uint64_t) i * num_candidates / ANYTIME_SAMPLE_SIZE];
+    packed_word_t guess = lookahead_guess_until(guesses, num_guesses, sample, ANYTIME_SAMPLE_SIZE, &deadline, NULL);
+    free(sample);
+    if (guess == 0) goto done;
+
+    result->guess = guess;
+    result->stage = ANYTIME_SAMPLED;
+  }
+
+  if (num_candidates > LOOKAHEAD_MAX_CANDIDATES) goto done;
+  packed_word_t guess = lookahead_guess_until(guesses, num_guesses, candidates, num_candidates, &deadline, NULL);
+  if (guess != 0) {
+    result->guess = guess;
+    result->stage = ANYTIME_FULL;
+  }
+
+ done:
+  result->seconds = seconds_since(&start);
+  return 1;
+}
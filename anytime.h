@@ -0,0 +1,43 @@
+#pragma once
+
+#include "batch.h"
+
+/* Number of candidates, evenly spaced, that the sampled lookahead
+   stage of `anytime_guess` evaluates guesses against. With no more
+   candidates than this, the stage is skipped. */
+#define ANYTIME_SAMPLE_SIZE 256
+
+/* Stages of `anytime_guess`, from the fastest to the most thorough. */
+typedef enum anytime_stage {
+
+  /** The fallback guess given by the caller, or the first candidate:
+      no stage finished in time. */
+  ANYTIME_FALLBACK,
+
+  /** The guess expected to give the most information, from
+      `best_guess`. */
+  ANYTIME_GREEDY,
+
+  /** The best guess two guesses ahead, from `lookahead_guess`, for a
+      sample of the candidates. */
+  ANYTIME_SAMPLED,
+
+  /** The best guess two guesses ahead for all candidates, when there
+      are no more than LOOKAHEAD_MAX_CANDIDATES. */
+  ANYTIME_FULL
+} anytime_stage_t;
+
+typedef struct anytime_result {
+
+  /** The guess found by the last stage that finished. */
+  packed_word_t guess;
+
+  /** The last stage that finished. */
+  anytime_stage_t stage;
+
+  /** Time spent, in seconds, including any stage that was cut short. */
+  double seconds;
+} anytime_result_t;
+
+int anytime_guess(const packed_word_t[], unsigned int, const packed_word_t[], unsigned int, double,
+                  packed_word_t, anytime_result_t *);
@@ -0,0 +1,363 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "batch.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/* Number of words processed together by the vector kernels. Vectors
+   use GCC vector extensions, which are lowered to whatever the target
+   supports (SSE2 on any x86-64, AVX2 when enabled at compile time).
+   Scoring works on one byte per word, since letters and pattern codes
+   both fit in a byte. */
+#define LANES 16
+#define RANK_LANES 4
+
+#define LETTER_BITS 5
+#define LETTER_MASK 0x1fu
+
+typedef uint32_t vpacked_t __attribute__((vector_size(LANES * sizeof(uint32_t))));
+typedef uint8_t vbyte_t __attribute__((vector_size(LANES)));
+typedef int8_t vmask_t __attribute__((vector_size(LANES)));
+
+typedef uint32_t vrank_t __attribute__((vector_size(RANK_LANES * sizeof(uint32_t))));
+typedef int32_t vrank_mask_t __attribute__((vector_size(RANK_LANES * sizeof(int32_t))));
+typedef uint64_t vbits_t __attribute__((vector_size(RANK_LANES * sizeof(uint64_t))));
+
+static const uint32_t powers_of_3[WORD_SIZE] = { 1, 3, 9, 27, 81 };
+static const uint32_t powers_of_26[WORD_SIZE] = { 1, 26, 676, 17576, 456976 };
+
+/**
+   Packs a word into a single integer. See `packed_word_t`.
+
+   @param word a zero-terminated string.
+
+   @returns the packed word, or zero if `word` does not have exactly
+   WORD_SIZE lowercase letters.
+ */
+packed_word_t pack_word(const char word[]) {
+  packed_word_t packed = 0;
+
+  for (int i = 0; i < WORD_SIZE; i++) {
+    if (word[i] < 'a' || word[i] > 'z') return 0;
+    packed |= (packed_word_t) (word[i] - 'a' + 1) << (LETTER_BITS * i);
+  }
+  if (word[WORD_SIZE] != '\0') return 0;
+
+  return packed;
+}
+
+/**
+   Converts a packed word back to a string.
+
+   @param word an array where the word is to be stored, followed by a
+   zero-termination byte. Must have space for at least WORD_SIZE+1
+   characters.
+ */
+void unpack_word(packed_word_t packed, char word[]) {
+  for (int i = 0; i < WORD_SIZE; i++)
+    word[i] = 'a' - 1 + ((packed >> (LETTER_BITS * i)) & LETTER_MASK);
+  word[WORD_SIZE] = '\0';
+}
+
+/**
+   Encodes the result array set by `compare_result` as a pattern
+   code. See `pattern_t`.
+ */
+pattern_t pattern_from_result(const letter_result_t result[]) {
+  unsigned int pattern = 0;
+  for (int i = WORD_SIZE - 1; i >= 0; i--) pattern = 3 * pattern + result[i];
+  return pattern;
+}
+
+/**
+   Decodes a pattern code into a result array, as would be set by
+   `compare_result`. `result` must have space for WORD_SIZE elements.
+ */
+void pattern_to_result(pattern_t pattern, letter_result_t result[]) {
+  for (int i = 0; i < WORD_SIZE; i++) {
+    result[i] = pattern % 3;
+    pattern /= 3;
+  }
+}
+
+/**
+   Initializes an empty set of words.
+
+   @returns a non-zero value if the set was initialized, or zero if
+   memory could not be allocated. The set must be released with
+   `word_set_free` if this function succeeds.
+ */
+int word_set_init(word_set_t *set) {
+  set->bits = calloc((NUM_PACKED_WORDS + 63) / 64, sizeof(uint64_t));
+  return set->bits != NULL;
+}
+
+void word_set_free(word_set_t *set) {
+  free(set->bits);
+  set->bits = NULL;
+}
+
+/**
+   Converts a packed word to its index in `word_set_t`.
+
+   @returns the index, or NUM_PACKED_WORDS if the value is not a valid
+   packed word.
+ */
+static uint32_t word_rank(packed_word_t packed) {
+  uint32_t rank = 0;
+
+  if (packed >> (LETTER_BITS * WORD_SIZE)) return NUM_PACKED_WORDS;
+  for (int i = 0; i < WORD_SIZE; i++) {
+    uint32_t letter = (packed >> (LETTER_BITS * i)) & LETTER_MASK;
+    if (letter < 1 || letter > 26) return NUM_PACKED_WORDS;
+    rank += (letter - 1) * powers_of_26[i];
+  }
+  return rank;
+}
+
+/**
+   Adds a packed word to the set. Values that are not valid packed
+   words are ignored.
+ */
+void word_set_add(word_set_t *set, packed_word_t packed) {
+  uint32_t rank = word_rank(packed);
+  if (rank < NUM_PACKED_WORDS) set->bits[rank / 64] |= UINT64_C(1) << (rank % 64);
+}
+
+/**
+   @returns a non-zero value if the packed word is in the set, or zero
+   otherwise.
+ */
+int word_set_contains(const word_set_t *set, packed_word_t packed) {
+  uint32_t rank = word_rank(packed);
+  return rank < NUM_PACKED_WORDS && (set->bits[rank / 64] >> (rank % 64)) & 1;
+}
+
+/**
+   Computes the base-26 rank of RANK_LANES packed words at once. Lanes
+   that do not hold a valid packed word are set to NUM_PACKED_WORDS.
+ */
+static vrank_t word_rank_vec(const packed_word_t packed[]) {
+  vrank_t words, rank = { 0 };
+  memcpy(&words, packed, sizeof(words));
+  vrank_mask_t invalid = (words >> (LETTER_BITS * WORD_SIZE)) != 0;
+
+  for (int i = 0; i < WORD_SIZE; i++) {
+    vrank_t letter = (words >> (LETTER_BITS * i)) & LETTER_MASK;
+    invalid |= (letter - 1) > 25;
+    rank += (letter - 1) * powers_of_26[i];
+  }
+  return (rank & ~(vrank_t) invalid) | ((vrank_t) invalid & NUM_PACKED_WORDS);
+}
+
+/**
+   Loads the bitmap words at RANK_LANES positions into one vector, with
+   a single gather instruction when AVX2 is enabled at compile time.
+ */
+static inline void gather_bits(const uint64_t bits[], vrank_t index, vbits_t *words) {
+#ifdef __AVX2__
+  __m128i indices;
+  memcpy(&indices, &index, sizeof(indices));
+  __m256i gathered = _mm256_i32gather_epi64((const long long *) bits, indices, sizeof(uint64_t));
+  memcpy(words, &gathered, sizeof(*words));
+#else
+  for (int lane = 0; lane < RANK_LANES; lane++) (*words)[lane] = bits[index[lane]];
+#endif
+}
+
+/**
+   Checks a list of packed guesses against a set of valid words.
+   Nothing is printed for invalid words.
+
+   @param set the set of valid words.
+
+   @param guesses the packed words to be checked. Values that are not
+   valid packed words (e.g., zero) are reported as invalid.
+
+   @param num_guesses the number of items in `guesses`.
+
+   @param valid a bitmap where the results are stored: bit `i % 64` of
+   `valid[i / 64]` is set if `guesses[i]` is in the set, and cleared
+   otherwise. Must have space for at least `(num_guesses + 63) / 64`
+   elements.
+ */
+void batch_validate(const word_set_t *set, const packed_word_t guesses[], size_t num_guesses, uint64_t valid[]) {
+  const vbits_t lane_shift = { 0, 1, 2, 3 };
+
+  /* Ranks, bitmap words and membership bits all stay in vectors; each
+     group of lanes yields RANK_LANES consecutive bits of the result,
+     and every result word is written once. */
+  for (size_t word = 0; word < (num_guesses + 63) / 64; word++) {
+    uint64_t result = 0;
+
+    for (size_t offset = 0; offset < 64; offset += RANK_LANES) {
+      size_t start = word * 64 + offset;
+      if (start >= num_guesses) break;
+
+      size_t count = num_guesses - start < RANK_LANES ? num_guesses - start : RANK_LANES;
+      packed_word_t packed[RANK_LANES] = { 0 };
+      memcpy(packed, guesses + start, count * sizeof(packed_word_t));
+
+      /* Invalid lanes read the first bitmap word and are then cleared. */
+      vrank_t rank = word_rank_vec(packed);
+      vrank_mask_t in_range = rank < NUM_PACKED_WORDS;
+      vrank_t index = (rank / 64) & (vrank_t) in_range;
+      vbits_t present;
+      gather_bits(set->bits, index, &present);
+      present >>= __builtin_convertvector(rank % 64, vbits_t);
+      present &= __builtin_convertvector(in_range, vbits_t) & 1;
+      present <<= lane_shift;
+
+      result |= (present[0] | present[1] | present[2] | present[3]) << offset;
+    }
+    valid[word] = result;
+  }
+}
+
+/**
+   Splits LANES packed words into one vector per letter position.
+ */
+static inline void load_letters(const packed_word_t words[], vbyte_t letters[]) {
+  vpacked_t packed;
+  memcpy(&packed, words, sizeof(packed));
+  for (int i = 0; i < WORD_SIZE; i++)
+    letters[i] = __builtin_convertvector((packed >> (LETTER_BITS * i)) & LETTER_MASK, vbyte_t);
+}
+
+/**
+   Sets every lane of one vector per letter position to the letters of
+   a single packed word.
+ */
+static inline void broadcast_letters(packed_word_t word, vbyte_t letters[]) {
+  for (int i = 0; i < WORD_SIZE; i++)
+    letters[i] = (uint8_t) ((word >> (LETTER_BITS * i)) & LETTER_MASK) - (vbyte_t) { 0 };
+}
+
+/**
+   Computes the feedback pattern of LANES pairs of words at once,
+   following the same rules as `compare_result`. Comparisons yield
+   all-ones masks, so every step is a lane-wise bitwise operation and
+   no lane depends on any other.
+ */
+static inline vbyte_t score_vec(const vbyte_t guess[], const vbyte_t answer[]) {
+  vmask_t green[WORD_SIZE], unmatched[WORD_SIZE];
+  vbyte_t code[WORD_SIZE];
+  vbyte_t pattern = { 0 };
+
+  for (int i = 0; i < WORD_SIZE; i++) {
+    green[i] = guess[i] == answer[i];
+    unmatched[i] = ~green[i];
+  }
+
+  for (int i = 0; i < WORD_SIZE; i++) {
+    vmask_t yellow = { 0 };
+    for (int j = 0; j < WORD_SIZE; j++) {
+      vmask_t match = unmatched[j] & ~green[i] & ~yellow & (guess[i] == answer[j]);
+      unmatched[j] &= ~match;
+      yellow |= match;
+    }
+    code[i] = ((vbyte_t) green[i] & LR_IN_PLACE) | ((vbyte_t) yellow & LR_WRONG_PLACE);
+  }
+
+  for (int i = WORD_SIZE - 1; i >= 0; i--) pattern = pattern + pattern + pattern + code[i];
+  return pattern;
+}
+
+/**
+   Computes the feedback pattern for a single guess against a single
+   answer. Equivalent to `compare_result` followed by
+   `pattern_from_result`.
+ */
+pattern_t score_word(packed_word_t guess, packed_word_t answer) {
+  unsigned int guess_letters[WORD_SIZE], answer_letters[WORD_SIZE];
+  int used[WORD_SIZE];
+  unsigned int pattern = 0;
+
+  for (int i = 0; i < WORD_SIZE; i++) {
+    guess_letters[i] = (guess >> (LETTER_BITS * i)) & LETTER_MASK;
+    answer_letters[i] = (answer >> (LETTER_BITS * i)) & LETTER_MASK;
+    used[i] = guess_letters[i] == answer_letters[i];
+  }
+
+  for (int i = 0; i < WORD_SIZE; i++) {
+    letter_result_t code = LR_INCORRECT;
+    if (guess_letters[i] == answer_letters[i]) {
+      code = LR_IN_PLACE;
+    } else {
+      for (int j = 0; j < WORD_SIZE; j++) {
+        if (!used[j] && guess_letters[i] == answer_letters[j]) {
+          used[j] = 1;
+          code = LR_WRONG_PLACE;
+          break;
+        }
+      }
+    }
+    pattern += code * powers_of_3[i];
+  }
+  return pattern;
+}
+
+/**
+   Scores one guess against many answers.
+
+   @param guess the packed guessed word.
+
+   @param answers the packed answers to be compared against the guess.
+
+   @param num_answers the number of items in `answers`.
+
+   @param patterns an array where the pattern for each answer is
+   stored. Must have space for `num_answers` elements.
+ */
+void batch_score_answers(packed_word_t guess, const packed_word_t answers[], size_t num_answers, pattern_t patterns[]) {
+  vbyte_t guess_letters[WORD_SIZE], answer_letters[WORD_SIZE];
+  size_t start = 0;
+
+  broadcast_letters(guess, guess_letters);
+  for (; start + LANES <= num_answers; start += LANES) {
+    load_letters(answers + start, answer_letters);
+    vbyte_t result = score_vec(guess_letters, answer_letters);
+    memcpy(patterns + start, &result, sizeof(result));
+  }
+  if (start < num_answers) {
+    packed_word_t tail[LANES] = { 0 };
+    memcpy(tail, answers + start, (num_answers - start) * sizeof(packed_word_t));
+    load_letters(tail, answer_letters);
+    vbyte_t result = score_vec(guess_letters, answer_letters);
+    memcpy(patterns + start, &result, num_answers - start);
+  }
+}
+
+/**
+   Scores many guesses against one answer.
+
+   @param guesses the packed guessed words.
+
+   @param num_guesses the number of items in `guesses`.
+
+   @param answer the packed answer the guesses are compared against.
+
+   @param patterns an array where the pattern for each guess is
+   stored. Must have space for `num_guesses` elements.
+ */
+void batch_score_guesses(const packed_word_t guesses[], size_t num_guesses, packed_word_t answer, pattern_t patterns[]) {
+  vbyte_t guess_letters[WORD_SIZE], answer_letters[WORD_SIZE];
+  size_t start = 0;
+
+  broadcast_letters(answer, answer_letters);
+  for (; start + LANES <= num_guesses; start += LANES) {
+    load_letters(guesses + start, guess_letters);
+    vbyte_t result = score_vec(guess_letters, answer_letters);
+    memcpy(patterns + start, &result, sizeof(result));
+  }
+  if (start < num_guesses) {
+    packed_word_t tail[LANES] = { 0 };
+    memcpy(tail, guesses + start, (num_guesses - start) * sizeof(packed_word_t));
+    load_letters(tail, guess_letters);
+    vbyte_t result = score_vec(guess_letters, answer_letters);
+    memcpy(patterns + start, &result, num_guesses - start);
+  }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game.h"
+
+#if WORD_SIZE != 5
+#error "packed words and pattern codes assume five-letter words"
+#endif
+
+/* Number of distinct feedback patterns for one guess (3^WORD_SIZE),
+   and the pattern code of a guess that matches the answer. */
+#define NUM_PATTERNS   243
+#define PATTERN_SOLVED 242
+
+/* Number of distinct words that can be packed (26^WORD_SIZE). */
+#define NUM_PACKED_WORDS 11881376u
+
+/** A word stored in a single integer: 5 bits per letter, with the
+    first letter in the lowest bits. Letters are stored as 1 for 'a'
+    up to 26 for 'z', so zero is never a valid packed word. */
+typedef uint32_t packed_word_t;
+
+/** Feedback for a guess encoded as a number from 0 to NUM_PATTERNS-1:
+    the sum of `result[i] * 3^i` over all letters, where `result` is
+    the array set by `compare_result`. */
+typedef uint8_t pattern_t;
+
+typedef struct word_set {
+
+  /** One bit for every possible packed word, indexed by the word read
+      as a base-26 number. Set bits correspond to words in the set.
+      Takes about 1.5 MB however few words there are, for bulk jobs
+      that check many words at once; dictionaries use a DAWG. */
+  uint64_t *bits;
+} word_set_t;
+
+packed_word_t pack_word(const char[]);
+void unpack_word(packed_word_t, char[]);
+
+pattern_t pattern_from_result(const letter_result_t[]);
+void pattern_to_result(pattern_t, letter_result_t[]);
+
+int word_set_init(word_set_t *);
+void word_set_free(word_set_t *);
+void word_set_add(word_set_t *, packed_word_t);
+int word_set_contains(const word_set_t *, packed_word_t);
+
+void batch_validate(const word_set_t *, const packed_word_t[], size_t, uint64_t[]);
+
+pattern_t score_word(packed_word_t, packed_word_t);
+void batch_score_answers(packed_word_t, const packed_word_t[], size_t, pattern_t[]);
+void batch_score_guesses(const packed_word_t[], size_t, packed_word_t, pattern_t[]);
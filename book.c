@@ -0,0 +1,148 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "book.h"
+#include "solver.h"
+
+/* The first two guesses are the most expensive to find, as every word
+   or a large share of them may be the answer, but they only depend on
+   the dictionary. An opening book stores them, so that they are found
+   once per word list rather than once per game or per process. */
+
+/**
+   Computes the opening book of a dictionary: the best first guess, and
+   the best second guess for each feedback it may give. This takes as
+   long as finding the best guess for every feedback, so it is meant
+   to be done once, and the result saved with `opening_book_write`.
+
+   @param book where the book is stored.
+
+   @param dict the dictionary, whose words are both the guesses and the
+   possible answers.
+
+   @returns a non-zero value if the book was computed, or zero if the
+   dictionary is empty (errno is set to EINVAL) or memory could not be
+   allocated.
+ */
+int opening_book_build(opening_book_t *book, const yk_dict_t *dict) {
+  unsigned int num_words = dict->num_words;
+  int result = 0;
+
+  memset(book, 0, sizeof(*book));
+  book->dict_hash = yk_dict_hash(dict);
+  if (num_words == 0) {
+    errno = EINVAL;
+    return 0;
+  }
+
+  book->first_guess = best_guess(dict->words, num_words, dict->words, num_words, NULL);
+  if (book->first_guess == 0) return 0;
+
+  /* Words are sorted by feedback once, so each set of candidates is a
+     contiguous range. */
+  pattern_t *patterns = malloc(num_words * sizeof(*patterns));
+  packed_word_t *sorted = malloc(num_words * sizeof(*sorted));
+  unsigned int counts[NUM_PATTERNS] = { 0 }, next[NUM_PATTERNS];
+  if (patterns == NULL || sorted == NULL) goto done;
+
+  batch_score_answers(book->first_guess, dict->words, num_words, patterns);
+  for (unsigned int i = 0; i < num_words; i++) counts[patterns[i]]++;
+  next[0] = 0;
+  for (int p = 1; p < NUM_PATTERNS; p++) next[p] = next[p - 1] + counts[p - 1];
+  for (unsigned int i = 0; i < num_words; i++) sorted[next[patterns[i]]++] = dict->words[i];
+
+  for (int p = 0; p < NUM_PATTERNS; p++) {
+    if (counts[p] == 0 || p == PATTERN_SOLVED) continue;
+    const packed_word_t *candidates = sorted + next[p] - counts[p];
+    book->second_guesses[p] = best_guess(dict->words, num_words, candidates, counts[p], NULL);
+    if (book->second_guesses[p] == 0) goto done;
+  }
+  result = 1;
+
+ done:
+  free(patterns);
+  free(sorted);
+  return result;
+}
+
+/**
+   Writes an opening book to a file, in the byte order of the machine.
+
+   @returns a non-zero value on success, or zero if the book could not
+   be written.
+ */
+int opening_book_write(FILE *fh, const opening_book_t *book) {
+  return fwrite(BOOK_MAGIC, 1, sizeof(BOOK_MAGIC) - 1, fh) == sizeof(BOOK_MAGIC) - 1
+    && fwrite(&book->dict_hash, sizeof(book->dict_hash), 1, fh) == 1
+    && fwrite(&book->first_guess, sizeof(book->first_guess), 1, fh) == 1
+    && fwrite(book->second_guesses, sizeof(*book->second_guesses), NUM_PATTERNS, fh) == NUM_PATTERNS;
+}
+
+/**
+   Reads an opening book written by `opening_book_write`.
+
+   @returns a non-zero value if the book was read, or zero if it could
+   not be read or is truncated.
+ */
+int opening_book_read(FILE *fh, opening_book_t *book) {
+  char magic[sizeof(BOOK_MAGIC) - 1];
+
+  return fread(magic, sizeof(magic), 1, fh) == 1 && memcmp(magic, BOOK_MAGIC, sizeof(magic)) == 0
+    && fread(&book->dict_hash, sizeof(book->dict_hash), 1, fh) == 1
+    && fread(&book->first_guess, sizeof(book->first_guess), 1, fh) == 1
+    && fread(book->second_guesses, sizeof(*book->second_guesses), NUM_PATTERNS, fh) == NUM_PATTERNS
+    && fgetc(fh) == EOF && book->first_guess != 0;
+}
+
+/**
+   Reads the opening book of a dictionary from a file.
+
+   @param book where the book is stored.
+
+   @param dict the dictionary the book must have been computed for.
+
+   @param filename the path of the file.
+
+   @returns a non-zero value if the book was read, or zero if the file
+   could not be opened, is not a valid book (errno is set to EINVAL) or
+   was computed for another dictionary (errno is set to ESTALE).
+ */
+int opening_book_load(opening_book_t *book, const yk_dict_t *dict, const char filename[]) {
+  FILE *fh = fopen(filename, "rb");
+  if (fh == NULL) return 0;
+
+  int read = opening_book_read(fh, book);
+  fclose(fh);
+  if (!read) {
+    errno = EINVAL;
+    return 0;
+  }
+  if (book->dict_hash != yk_dict_hash(dict)) {
+    errno = ESTALE;
+    return 0;
+  }
+  return 1;
+}
+
+/**
+   Looks up the best guess in an opening book.
+
+   @param book the book, or NULL.
+
+   @param num_guesses the number of guesses made so far.
+
+   @param first_guess the first guess, if one was made.
+
+   @param pattern the feedback for the first guess, if one was made.
+
+   @returns the best guess, or zero if it is not in the book: after
+   more than one guess, or after a first guess other than the book's.
+ */
+packed_word_t opening_book_guess(const opening_book_t *book, unsigned int num_guesses,
+                                 packed_word_t first_guess, pattern_t pattern) {
+  if (book == NULL) return 0;
+  if (num_guesses == 0) return book->first_guess;
+  if (num_guesses == 1 && first_guess == book->first_guess) return book->second_guesses[pattern];
+  return 0;
+}
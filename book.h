@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "engine.h"
+
+#define BOOK_MAGIC "YKOB0001"
+
+/* File the game keeps the opening book in, rebuilt when the word list
+   changes. Strategy plugins read it from the same place. */
+#define OPENING_BOOK_FILENAME "book.bin"
+
+typedef struct opening_book {
+
+  /** Hash of the dictionary the book was computed for, as given by
+      `yk_dict_hash`. */
+  uint64_t dict_hash;
+
+  /** The guess `best_guess` finds when every word may be the answer. */
+  packed_word_t first_guess;
+
+  /** For each feedback of `first_guess`, the guess `best_guess` finds
+      for the words that give it, or zero if no word does or the
+      feedback means the answer was found. */
+  packed_word_t second_guesses[NUM_PATTERNS];
+} opening_book_t;
+
+int opening_book_build(opening_book_t *, const yk_dict_t *);
+int opening_book_read(FILE *, opening_book_t *);
+int opening_book_write(FILE *, const opening_book_t *);
+int opening_book_load(opening_book_t *, const yk_dict_t *, const char[]);
+packed_word_t opening_book_guess(const opening_book_t *, unsigned int, packed_word_t, pattern_t);
@@ -0,0 +1,82 @@
+#define _GNU_SOURCE
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "counters.h"
+
+/* Counts of finished games shared by many processes, e.g., the
+   sessions of a server. Each CPU adds to its own shard, so finishing
+   a game takes no lock and only touches a cache line that other CPUs
+   rarely need; the shards are only added up when the counts are
+   read. */
+
+/**
+   Creates a set of counters, all zero, in anonymous shared memory, so
+   that processes forked afterwards all update the same counters.
+
+   @param counters the struct to be initialized. Must be released with
+   `outcome_counters_free` if this function succeeds.
+
+   @returns a non-zero value if the counters were created, or zero if
+   the memory could not be mapped.
+ */
+int outcome_counters_init(outcome_counters_t *counters) {
+  long num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+
+  counters->num_shards = num_cpus > 0 ? num_cpus : 1;
+  counters->shards = mmap(NULL, counters->num_shards * sizeof(*counters->shards),
+                          PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (counters->shards == MAP_FAILED) {
+    counters->shards = NULL;
+    return 0;
+  }
+  return 1;
+}
+
+/**
+   Releases counters created with `outcome_counters_init`, in this
+   process only.
+ */
+void outcome_counters_free(outcome_counters_t *counters) {
+  munmap(counters->shards, counters->num_shards * sizeof(*counters->shards));
+  counters->shards = NULL;
+}
+
+/**
+   Counts one finished game, in the shard of the CPU this process runs
+   on. Never blocks.
+
+   @param day the day the game was played, as given by `today`. Games
+   of days OUTCOME_DAYS apart are added to the same counters.
+
+   @param outcome the outcome of the game, as expected by
+   `save_stats`.
+ */
+void outcome_counters_add(outcome_counters_t *counters, int32_t day, unsigned int outcome) {
+  int cpu = sched_getcpu();
+  outcome_shard_t *shard = &counters->shards[cpu > 0 ? (unsigned int) cpu % counters->num_shards : 0];
+
+  if (outcome < 1 || outcome > NUM_OUTCOMES) return;
+  __atomic_fetch_add(&shard->counts[(uint32_t) day % OUTCOME_DAYS][outcome - 1], 1, __ATOMIC_RELAXED);
+}
+
+/**
+   Adds up the counts of all shards for a day. Games counted while this
+   runs may or may not be included.
+
+   @param day the day, as given to `outcome_counters_add`. The counts
+   include every day OUTCOME_DAYS apart from it since the counters were
+   created.
+
+   @param counts an array where the number of games with each outcome
+   is stored, indexed as in `outcome_shard_t`. Must have space for
+   NUM_OUTCOMES elements.
+ */
+void outcome_counters_read(const outcome_counters_t *counters, int32_t day, uint64_t counts[]) {
+  memset(counts, 0, NUM_OUTCOMES * sizeof(*counts));
+  for (unsigned int i = 0; i < counters->num_shards; i++)
+    for (int j = 0; j < NUM_OUTCOMES; j++)
+      counts[j] += __atomic_load_n(&counters->shards[i].counts[(uint32_t) day % OUTCOME_DAYS][j], __ATOMIC_RELAXED);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "game.h"
+
+/* Size of a cache line. Each shard of the counters takes whole lines,
+   so that shards updated from different CPUs never share one. */
+#define COUNTERS_LINE_SIZE 64
+
+/* Number of counters in each shard: one for each number of attempts
+   needed to win, and one for games that were lost. */
+#define NUM_OUTCOMES (MAX_NUM_ATTEMPTS + 1)
+
+/* Number of days counted separately. Days share counters in turn, so
+   the counts of a day must be read before the counters are reused,
+   OUTCOME_DAYS days later; until then, games played just before
+   midnight can still be told from those played just after. */
+#define OUTCOME_DAYS 2
+
+typedef struct outcome_shard {
+
+  /** Games finished with each outcome, for days in turn (see
+      `outcome_counters_add`), indexed by the outcome minus one (as
+      expected by `save_stats`, MAX_NUM_ATTEMPTS+1 for a game that was
+      lost). */
+  uint64_t counts[OUTCOME_DAYS][NUM_OUTCOMES];
+} __attribute__((aligned(COUNTERS_LINE_SIZE))) outcome_shard_t;
+
+typedef struct outcome_counters {
+
+  /** One shard per CPU, in memory shared with every process forked
+      after the counters were created. */
+  outcome_shard_t *shards;
+
+  unsigned int num_shards;
+} outcome_counters_t;
+
+int outcome_counters_init(outcome_counters_t *);
+void outcome_counters_free(outcome_counters_t *);
+void outcome_counters_add(outcome_counters_t *, int32_t, unsigned int);
+void outcome_counters_read(const outcome_counters_t *, int32_t, uint64_t[]);
@@ -0,0 +1,528 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "dawg.h"
+
+/* Layout of a packed edge: bits 0-4 hold the letter (0 for 'a'), bit
+   5 is set if a word ends after this letter, bit 6 is set on the last
+   edge of a node, and the remaining bits hold the child index. */
+#define EDGE_LETTER_MASK 0x1fu
+#define EDGE_END_OF_WORD 0x20u
+#define EDGE_LAST        0x40u
+#define EDGE_CHILD_SHIFT 7
+#define EDGE_MAX_CHILD   ((1u << (32 - EDGE_CHILD_SHIFT)) - 1)
+
+#define EDGE_LETTER(e) ((e) & EDGE_LETTER_MASK)
+#define EDGE_CHILD(e)  ((e) >> EDGE_CHILD_SHIFT)
+
+#define NUM_LETTERS 26
+
+/* A node that has not been added to the graph yet. Its edges are
+   stored without the EDGE_LAST flag; the child of the last edge is
+   the next node in the builder path and is filled in when that node
+   is frozen. */
+typedef struct build_node {
+  uint32_t edges[NUM_LETTERS];
+  unsigned int num_edges;
+} build_node_t;
+
+typedef struct builder {
+  dawg_t *dawg;
+  unsigned int capacity;
+
+  /* Open-addressing table of frozen nodes, indexed by a hash of their
+     edges. Holds the index of the header of each node, or zero for
+     empty slots. */
+  unsigned int *registry;
+  unsigned int registry_size;
+  unsigned int registry_used;
+
+  build_node_t path[DAWG_MAX_WORD_LENGTH + 1];
+} builder_t;
+
+static uint32_t hash_edges(const uint32_t edges[], unsigned int num_edges) {
+  uint32_t hash = 2166136261u;
+  for (unsigned int i = 0; i < num_edges; i++) {
+    hash ^= edges[i] & ~EDGE_LAST;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static int same_node(const dawg_t *dawg, unsigned int id, const build_node_t *node) {
+  for (unsigned int i = 0; i < node->num_edges; i++) {
+    uint32_t edge = dawg->edges[id + 1 + i];
+    int last = (edge & EDGE_LAST) != 0;
+    if ((edge & ~EDGE_LAST) != node->edges[i]) return 0;
+    if (last != (i == node->num_edges - 1)) return 0;
+  }
+  return 1;
+}
+
+static int grow_registry(builder_t *builder) {
+  unsigned int new_size = builder->registry_size ? builder->registry_size * 2 : 1024;
+  unsigned int *table = calloc(new_size, sizeof(*table));
+  if (table == NULL) return 0;
+
+  for (unsigned int i = 0; i < builder->registry_size; i++) {
+    unsigned int id = builder->registry[i];
+    if (id == 0) continue;
+
+    unsigned int num_edges = __builtin_popcount(builder->dawg->edges[id]);
+    uint32_t run[NUM_LETTERS];
+    for (unsigned int j = 0; j < num_edges; j++)
+      run[j] = builder->dawg->edges[id + 1 + j] & ~EDGE_LAST;
+
+    unsigned int slot = hash_edges(run, num_edges) & (new_size - 1);
+    while (table[slot] != 0) slot = (slot + 1) & (new_size - 1);
+    table[slot] = id;
+  }
+
+  free(builder->registry);
+  builder->registry = table;
+  builder->registry_size = new_size;
+  return 1;
+}
+
+/**
+   Adds a node to the graph, reusing an equivalent node if one was
+   already added. Two nodes are equivalent if they have the same
+   edges, since all their children have been frozen before them.
+
+   @returns the index of the header of the node in the graph, zero if
+   the node has no edges, or -1 if memory could not be allocated.
+ */
+static long freeze_node(builder_t *builder, const build_node_t *node) {
+  dawg_t *dawg = builder->dawg;
+
+  if (node->num_edges == 0) return 0;
+
+  if (2 * (builder->registry_used + 1) > builder->registry_size)
+    if (!grow_registry(builder)) return -1;
+
+  unsigned int mask = builder->registry_size - 1;
+  unsigned int slot = hash_edges(node->edges, node->num_edges) & mask;
+  while (builder->registry[slot] != 0) {
+    if (same_node(dawg, builder->registry[slot], node)) return builder->registry[slot];
+    slot = (slot + 1) & mask;
+  }
+
+  if (dawg->num_edges > EDGE_MAX_CHILD) {
+    errno = EOVERFLOW;
+    return -1;
+  }
+  if (dawg->num_edges + node->num_edges + 1 > builder->capacity) {
+    unsigned int capacity = builder->capacity * 2;
+    uint32_t *edges = realloc(dawg->edges, capacity * sizeof(*edges));
+    if (edges == NULL) return -1;
+    dawg->edges = edges;
+    builder->capacity = capacity;
+  }
+
+  unsigned int id = dawg->num_edges;
+  dawg->edges[id] = 0;
+  for (unsigned int i = 0; i < node->num_edges; i++) dawg->edges[id] |= 1u << EDGE_LETTER(node->edges[i]);
+  memcpy(dawg->edges + id + 1, node->edges, node->num_edges * sizeof(node->edges[0]));
+  dawg->edges[id + node->num_edges] |= EDGE_LAST;
+  dawg->num_edges += node->num_edges + 1;
+
+  builder->registry[slot] = id;
+  builder->registry_used++;
+  return id;
+}
+
+/**
+   Freezes the nodes in the builder path that are deeper than `depth`,
+   linking each of them to the last edge of its parent.
+ */
+static int freeze_path(builder_t *builder, unsigned int from, unsigned int depth) {
+  for (unsigned int d = from; d > depth; d--) {
+    long id = freeze_node(builder, &builder->path[d]);
+    if (id < 0) return 0;
+    build_node_t *parent = &builder->path[d - 1];
+    parent->edges[parent->num_edges - 1] |= (uint32_t) id << EDGE_CHILD_SHIFT;
+  }
+  return 1;
+}
+
+static int compare_words(const void *a, const void *b) {
+  return strcmp(*(const char **) a, *(const char **) b);
+}
+
+/**
+   Fills in `dawg->ranks` once every node is frozen. Children are
+   frozen before their parents, so they come first in `edges`, and a
+   single pass over the nodes in order counts the words below every
+   node before any edge leading to it is reached.
+
+   @returns a non-zero value on success, or zero if memory could not
+   be allocated.
+ */
+static int rank_edges(dawg_t *dawg) {
+  /* Number of words below each node, by the index of its header. */
+  uint32_t *below = calloc(dawg->num_edges, sizeof(*below));
+  dawg->ranks = malloc(dawg->num_edges * sizeof(*dawg->ranks));
+  if (below == NULL || dawg->ranks == NULL) {
+    free(below);
+    return 0;
+  }
+
+  dawg->ranks[0] = 0;
+  for (unsigned int id = 1; id < dawg->num_edges;) {
+    unsigned int num_edges = __builtin_popcount(dawg->edges[id]);
+    uint32_t sum = 0;
+
+    dawg->ranks[id] = 0;
+    for (unsigned int i = id + 1; i <= id + num_edges; i++) {
+      uint32_t edge = dawg->edges[i];
+      dawg->ranks[i] = sum;
+      sum += ((edge & EDGE_END_OF_WORD) != 0) + below[EDGE_CHILD(edge)];
+    }
+    below[id] = sum;
+    id += num_edges + 1;
+  }
+  free(below);
+  return 1;
+}
+
+/**
+   Builds a minimized DAWG (directed acyclic word graph) containing the
+   given words. Words do not need to be sorted, and duplicates are
+   only stored once. Only lowercase letters are accepted.
+
+   Nodes are frozen as soon as no further words can be added below
+   them, so memory used while building is proportional to the final
+   graph rather than to an uncompressed trie.
+
+   @param dawg the struct to be initialized. Must be released with
+   `dawg_free` if this function succeeds.
+
+   @param words the list of words to be stored.
+
+   @param num_words the number of items in `words`.
+
+   @returns a non-zero value if the DAWG was built, or zero if a word
+   is invalid (errno is set to EINVAL) or memory could not be
+   allocated.
+ */
+int dawg_build(dawg_t *dawg, const char *words[], unsigned int num_words) {
+  builder_t builder = { .dawg = dawg, .capacity = 1024 };
+  const char **sorted = NULL;
+  const char *previous = "";
+  unsigned int previous_length = 0;
+
+  dawg->edges = malloc(builder.capacity * sizeof(*dawg->edges));
+  dawg->ranks = NULL;
+  dawg->num_edges = 1;
+  dawg->root = 0;
+  dawg->num_words = 0;
+
+  sorted = malloc((num_words ? num_words : 1) * sizeof(*sorted));
+  if (dawg->edges == NULL || sorted == NULL) goto error;
+  dawg->edges[0] = 0;
+  memcpy(sorted, words, num_words * sizeof(*sorted));
+  qsort(sorted, num_words, sizeof(*sorted), compare_words);
+
+  for (unsigned int w = 0; w < num_words; w++) {
+    const char *word = sorted[w];
+    unsigned int length = strlen(word);
+
+    if (length == 0 || length > DAWG_MAX_WORD_LENGTH) {
+      errno = EINVAL;
+      goto error;
+    }
+    for (unsigned int i = 0; i < length; i++) {
+      if (word[i] < 'a' || word[i] > 'z') {
+        errno = EINVAL;
+        goto error;
+      }
+    }
+    if (strcmp(word, previous) == 0) continue;
+
+    unsigned int common = 0;
+    while (common < previous_length && word[common] == previous[common]) common++;
+
+    if (!freeze_path(&builder, previous_length, common)) goto error;
+
+    for (unsigned int d = common; d < length; d++) {
+      build_node_t *node = &builder.path[d];
+      node->edges[node->num_edges++] = word[d] - 'a';
+      builder.path[d + 1].num_edges = 0;
+    }
+    build_node_t *end = &builder.path[length - 1];
+    end->edges[end->num_edges - 1] |= EDGE_END_OF_WORD;
+
+    previous = word;
+    previous_length = length;
+    dawg->num_words++;
+  }
+
+  if (!freeze_path(&builder, previous_length, 0)) goto error;
+  long root = freeze_node(&builder, &builder.path[0]);
+  if (root < 0) goto error;
+  dawg->root = root;
+
+  free(builder.registry);
+  free(sorted);
+
+  uint32_t *edges = realloc(dawg->edges, dawg->num_edges * sizeof(*edges));
+  if (edges != NULL) dawg->edges = edges;
+  if (rank_edges(dawg)) return 1;
+  free(dawg->edges);
+  dawg->edges = NULL;
+  return 0;
+
+ error:
+  free(builder.registry);
+  free(sorted);
+  free(dawg->edges);
+  dawg->edges = NULL;
+  return 0;
+}
+
+/**
+   Reads a file containing words separated by spaces or line breaks and
+   builds a DAWG with them. There is no limit on the number of words.
+
+   @param dawg the struct to be initialized. Must be released with
+   `dawg_free` if this function succeeds.
+
+   @param filename name of the file to be read.
+
+   @returns a non-zero value if the words were successfully loaded, or
+   zero if an error happened while reading the file or building the
+   DAWG.
+ */
+int dawg_load(dawg_t *dawg, const char filename[]) {
+  char word[DAWG_MAX_WORD_LENGTH + 2];
+  char format[16];
+  char *text = NULL;
+  const char **words = NULL;
+  size_t text_size = 0, text_capacity = 0;
+  unsigned int num_words = 0;
+  int result = 0;
+
+  FILE *fh = fopen(filename, "r");
+  if (fh == NULL) return 0;
+
+  /* Words longer than the limit are read in full to be rejected by
+     `dawg_build`, rather than split into several words. */
+  snprintf(format, sizeof(format), "%%%ds", DAWG_MAX_WORD_LENGTH + 1);
+  while (fscanf(fh, format, word) == 1) {
+    size_t length = strlen(word) + 1;
+    if (text_size + length > text_capacity) {
+      text_capacity = text_capacity ? text_capacity * 2 : 65536;
+      char *grown = realloc(text, text_capacity);
+      if (grown == NULL) goto done;
+      text = grown;
+    }
+    memcpy(text + text_size, word, length);
+    text_size += length;
+    num_words++;
+  }
+
+  words = malloc((num_words ? num_words : 1) * sizeof(*words));
+  if (words == NULL) goto done;
+  for (size_t offset = 0, i = 0; i < num_words; i++) {
+    words[i] = text + offset;
+    offset += strlen(text + offset) + 1;
+  }
+
+  result = dawg_build(dawg, words, num_words);
+
+ done:
+  free(words);
+  free(text);
+  fclose(fh);
+  return result;
+}
+
+/**
+   Releases the memory used by a DAWG built with `dawg_build` or
+   `dawg_load`.
+ */
+void dawg_free(dawg_t *dawg) {
+  free(dawg->edges);
+  free(dawg->ranks);
+  dawg->edges = NULL;
+  dawg->ranks = NULL;
+  dawg->num_edges = 0;
+  dawg->root = 0;
+  dawg->num_words = 0;
+}
+
+/**
+   Finds the edge for a letter in the node starting at `node`. The
+   header of the node tells whether there is one, and how many edges
+   come before it, without looking at the edges.
+
+   @returns the index of the edge, or zero if there is none.
+ */
+static unsigned int find_edge(const dawg_t *dawg, unsigned int node, char letter) {
+  if (node == 0 || letter < 'a' || letter > 'z') return 0;
+
+  uint32_t header = dawg->edges[node], bit = 1u << (letter - 'a');
+  if (!(header & bit)) return 0;
+  return node + 1 + __builtin_popcount(header & (bit - 1));
+}
+
+/**
+   Checks if a word is stored in the DAWG.
+
+   @returns a non-zero value if `word` is in the DAWG, or zero
+   otherwise.
+ */
+int dawg_contains(const dawg_t *dawg, const char word[]) {
+  unsigned int node = dawg->root, edge = 0;
+
+  if (word[0] == '\0') return 0;
+
+  for (int i = 0; word[i] != '\0'; i++) {
+    edge = find_edge(dawg, node, word[i]);
+    if (edge == 0) return 0;
+    node = EDGE_CHILD(dawg->edges[edge]);
+  }
+  return (dawg->edges[edge] & EDGE_END_OF_WORD) != 0;
+}
+
+/**
+   Finds the position of a word among the words stored in the DAWG,
+   in alphabetical order, with one walk down the graph: the ranks of
+   the edges taken add up to the number of words before it. The DAWG
+   thus maps its words to consecutive numbers without storing them.
+
+   @returns the position of `word`, from 0 to `num_words - 1`, or -1
+   if `word` is not in the DAWG.
+ */
+long dawg_index(const dawg_t *dawg, const char word[]) {
+  unsigned int node = dawg->root, edge = 0;
+  long index = 0;
+
+  if (word[0] == '\0') return -1;
+
+  for (int i = 0; word[i] != '\0'; i++) {
+    /* A word that ends at the previous letter comes first. */
+    if (i > 0 && (dawg->edges[edge] & EDGE_END_OF_WORD)) index++;
+    edge = find_edge(dawg, node, word[i]);
+    if (edge == 0) return -1;
+    index += dawg->ranks[edge];
+    node = EDGE_CHILD(dawg->edges[edge]);
+  }
+  return (dawg->edges[edge] & EDGE_END_OF_WORD) ? index : -1;
+}
+
+typedef struct walk {
+  const dawg_t *dawg;
+  const char *pattern;
+  dawg_visit_t visit;
+  void *data;
+  unsigned int count;
+  int stopped;
+  char word[DAWG_MAX_WORD_LENGTH + 1];
+} walk_t;
+
+/**
+   Visits all words below `node`, in alphabetical order. The first
+   `depth` letters of `walk->word` are the letters leading to `node`.
+   If `walk->pattern` is set, only words of the same length as the
+   pattern and matching it are visited.
+ */
+static void walk_node(walk_t *walk, unsigned int node, unsigned int depth) {
+  const uint32_t *edges = walk->dawg->edges;
+
+  if (node == 0 || depth >= DAWG_MAX_WORD_LENGTH) return;
+
+  char wanted = 0;
+  if (walk->pattern != NULL) {
+    wanted = walk->pattern[depth];
+    if (wanted == '\0') return;
+  }
+
+  for (unsigned int i = node + 1; !walk->stopped; i++) {
+    uint32_t edge = edges[i];
+    char letter = 'a' + EDGE_LETTER(edge);
+
+    if (wanted == 0 || wanted == DAWG_WILDCARD || wanted == letter) {
+      walk->word[depth] = letter;
+
+      int complete = walk->pattern == NULL || walk->pattern[depth + 1] == '\0';
+      if ((edge & EDGE_END_OF_WORD) && complete) {
+        walk->word[depth + 1] = '\0';
+        walk->count++;
+        if (walk->visit != NULL && walk->visit(walk->word, walk->data)) walk->stopped = 1;
+      }
+      if (!walk->stopped) walk_node(walk, EDGE_CHILD(edge), depth + 1);
+    }
+
+    /* Edges are sorted and letters are unique within a node, so no
+       later edge can match a letter already reached. */
+    if ((edge & EDGE_LAST) || (wanted != 0 && wanted != DAWG_WILDCARD && letter >= wanted)) break;
+  }
+}
+
+/**
+   Visits all words in the DAWG starting with a given prefix, in
+   alphabetical order. The prefix itself is visited if it is a word.
+
+   @param prefix the prefix to search for. An empty prefix visits all
+   words.
+
+   @param visit function called for each word found. May be NULL if
+   only the count is needed.
+
+   @param data value passed to `visit`.
+
+   @returns the number of words visited.
+ */
+unsigned int dawg_enumerate_prefix(const dawg_t *dawg, const char prefix[], dawg_visit_t visit, void *data) {
+  walk_t walk = { .dawg = dawg, .visit = visit, .data = data };
+  unsigned int length = strlen(prefix);
+  unsigned int node = dawg->root;
+
+  if (length == 0) {
+    walk_node(&walk, node, 0);
+    return walk.count;
+  }
+  if (length > DAWG_MAX_WORD_LENGTH) return 0;
+
+  unsigned int edge = 0;
+  for (unsigned int i = 0; i < length; i++) {
+    edge = find_edge(dawg, node, prefix[i]);
+    if (edge == 0) return 0;
+    node = EDGE_CHILD(dawg->edges[edge]);
+  }
+
+  memcpy(walk.word, prefix, length);
+  if (dawg->edges[edge] & EDGE_END_OF_WORD) {
+    walk.word[length] = '\0';
+    walk.count++;
+    if (visit != NULL && visit(walk.word, data)) return walk.count;
+  }
+  walk_node(&walk, node, length);
+  return walk.count;
+}
+
+/**
+   Visits all words in the DAWG matching a pattern, in alphabetical
+   order. A pattern matches words of the same length where every
+   position has the same letter as the pattern, or the pattern has
+   DAWG_WILDCARD in that position. For example, `?r?ad` matches both
+   `bread` and `dread`.
+
+   @param pattern the pattern to be matched.
+
+   @param visit function called for each word found. May be NULL if
+   only the count is needed.
+
+   @param data value passed to `visit`.
+
+   @returns the number of words visited.
+ */
+unsigned int dawg_match(const dawg_t *dawg, const char pattern[], dawg_visit_t visit, void *data) {
+  walk_t walk = { .dawg = dawg, .pattern = pattern, .visit = visit, .data = data };
+
+  walk_node(&walk, dawg->root, 0);
+  return walk.count;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdint.h>
+
+/* Words are made of the letters 'a' to 'z' only, like the packed
+   words of the engine; each edge keeps its letter in five bits. */
+
+/* Longest word accepted when building a DAWG. */
+#define DAWG_MAX_WORD_LENGTH 32
+
+/* Character accepted in patterns passed to `dawg_match` as a
+   placeholder for any letter. */
+#define DAWG_WILDCARD '?'
+
+typedef struct dawg {
+
+  /** Packed edges of the minimized graph. Each node is stored as a
+      header, with one bit for the letter of each of its edges ('a' in
+      the lowest bit), followed by a contiguous run of edges sorted by
+      letter, the last of which is flagged as such. Every edge holds
+      its letter, whether a word ends after that letter, and the index
+      of the header of the child node. Index 0 is never used by a
+      node, so a child index of zero means the edge has no children. */
+  uint32_t *edges;
+
+  /** For each edge, the number of words below its node that come
+      before the words through the edge, in alphabetical order. Used
+      by `dawg_index` to number the words without storing them. */
+  uint32_t *ranks;
+
+  /** Number of items in `edges` and `ranks`, including headers and
+      the unused first one. */
+  unsigned int num_edges;
+
+  /** Index of the header of the root node, or zero if the DAWG holds
+      no words. */
+  unsigned int root;
+
+  /** Number of distinct words stored in the DAWG. */
+  unsigned int num_words;
+} dawg_t;
+
+/**
+   Function called for each word found by `dawg_enumerate_prefix` and
+   `dawg_match`. Returns a non-zero value to stop the enumeration.
+ */
+typedef int (*dawg_visit_t)(const char word[], void *data);
+
+int dawg_build(dawg_t *, const char *[], unsigned int);
+int dawg_load(dawg_t *, const char[]);
+void dawg_free(dawg_t *);
+
+int dawg_contains(const dawg_t *, const char[]);
+long dawg_index(const dawg_t *, const char[]);
+unsigned int dawg_enumerate_prefix(const dawg_t *, const char[], dawg_visit_t, void *);
+unsigned int dawg_match(const dawg_t *, const char[], dawg_visit_t, void *);
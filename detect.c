@@ -0,0 +1,215 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "detect.h"
+
+/* A player who does not know the answer gains, on average, exactly
+   the information their guesses are expected to give: the entropy of
+   the feedback over the remaining candidates. A player who knows the
+   answer gains more, because improbable feedback (such as solving the
+   game while many candidates remain) keeps happening to them. Each
+   player is scored by how many standard deviations their total excess
+   information is above zero. */
+
+/**
+   Computes the information metrics of one game.
+
+   @param detector provides the dictionary and scratch buffers.
+
+   @param answer the packed answer of the game.
+
+   @param guesses the packed guesses of the game, in order.
+
+   @param num_guesses the number of items in `guesses`.
+
+   @param metrics where the metrics are stored.
+
+   @returns a non-zero value if the metrics were computed, or zero if
+   the answer is not in the dictionary.
+ */
+int game_metrics(detector_t *detector, packed_word_t answer, const packed_word_t guesses[],
+                 unsigned int num_guesses, game_metrics_t *metrics) {
+  const yk_dict_t *dict = detector->dict;
+  packed_word_t *candidates = detector->candidates;
+  unsigned int num_candidates = dict->num_words;
+  unsigned int histogram[NUM_PATTERNS];
+
+  char word[WORD_SIZE + 1];
+
+  memset(metrics, 0, sizeof(*metrics));
+  if (answer == 0) return 0;
+  unpack_word(answer, word);
+  if (!yk_dict_contains(dict, word)) return 0;
+
+  memcpy(candidates, dict->words, num_candidates * sizeof(*candidates));
+
+  for (unsigned int g = 0; g < num_guesses && num_candidates > 1; g++) {
+    pattern_t pattern = score_word(guesses[g], answer);
+
+    batch_score_answers(guesses[g], candidates, num_candidates, detector->patterns);
+    memset(histogram, 0, sizeof(histogram));
+    for (unsigned int i = 0; i < num_candidates; i++) histogram[detector->patterns[i]]++;
+
+    /* Expected surprisal (entropy) and its variance over the feedback
+       the guess may get. */
+    double entropy = 0, second_moment = 0;
+    for (int p = 0; p < NUM_PATTERNS; p++) {
+      if (histogram[p] == 0) continue;
+      double probability = (double) histogram[p] / num_candidates;
+      double surprisal = -log2(probability);
+      entropy += probability * surprisal;
+      second_moment += probability * surprisal * surprisal;
+    }
+
+    metrics->expected_bits += entropy;
+    metrics->gained_bits += -log2((double) histogram[pattern] / num_candidates);
+    metrics->variance += second_moment - entropy * entropy;
+
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < num_candidates; i++) {
+      candidates[count] = candidates[i];
+      count += detector->patterns[i] == pattern;
+    }
+    num_candidates = count;
+  }
+
+  return 1;
+}
+
+/**
+   Prepares a detector for reading games.
+
+   @param detector the struct to be initialized. Must be released with
+   `detector_free` if this function succeeds.
+
+   @param dict the dictionary used in the games. Must not be released
+   while the detector is in use.
+
+   @returns a non-zero value if the detector was initialized, or zero
+   if memory could not be allocated.
+ */
+int detector_init(detector_t *detector, const yk_dict_t *dict) {
+  unsigned int size = dict->num_words ? dict->num_words : 1;
+
+  detector->dict = dict;
+  detector->num_players = 0;
+  detector->capacity = 1024;
+  detector->candidates = malloc(size * sizeof(*detector->candidates));
+  detector->patterns = malloc(size * sizeof(*detector->patterns));
+  detector->players = calloc(detector->capacity, sizeof(*detector->players));
+
+  if (detector->candidates == NULL || detector->patterns == NULL || detector->players == NULL) {
+    detector_free(detector);
+    return 0;
+  }
+  return 1;
+}
+
+void detector_free(detector_t *detector) {
+  if (detector->players != NULL)
+    for (unsigned int i = 0; i < detector->capacity; i++) free(detector->players[i].name);
+
+  free(detector->candidates);
+  free(detector->patterns);
+  free(detector->players);
+  detector->candidates = NULL;
+  detector->patterns = NULL;
+  detector->players = NULL;
+  detector->num_players = 0;
+}
+
+static uint32_t hash_name(const char name[]) {
+  uint32_t hash = 2166136261u;
+  for (; *name != '\0'; name++) {
+    hash ^= (unsigned char) *name;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static player_record_t *find_slot(player_record_t players[], unsigned int capacity, const char name[]) {
+  unsigned int slot = hash_name(name) & (capacity - 1);
+  while (players[slot].name != NULL && strcmp(players[slot].name, name) != 0)
+    slot = (slot + 1) & (capacity - 1);
+  return &players[slot];
+}
+
+/**
+   Finds the record of a player, adding it if it does not exist.
+
+   @returns the record, or NULL if memory could not be allocated.
+ */
+static player_record_t *find_player(detector_t *detector, const char name[]) {
+  if (2 * (detector->num_players + 1) > detector->capacity) {
+    unsigned int capacity = detector->capacity * 2;
+    player_record_t *players = calloc(capacity, sizeof(*players));
+    if (players == NULL) return NULL;
+
+    for (unsigned int i = 0; i < detector->capacity; i++)
+      if (detector->players[i].name != NULL)
+        *find_slot(players, capacity, detector->players[i].name) = detector->players[i];
+
+    free(detector->players);
+    detector->players = players;
+    detector->capacity = capacity;
+  }
+
+  player_record_t *record = find_slot(detector->players, detector->capacity, name);
+  if (record->name == NULL) {
+    record->name = strdup(name);
+    if (record->name == NULL) return NULL;
+    detector->num_players++;
+  }
+  return record;
+}
+
+/**
+   Adds one game to the record of a player. Only the totals of each
+   player are kept, so any number of games can be read in a single
+   pass.
+
+   @param detector the detector state.
+
+   @param player the name of the player.
+
+   @param answer the answer of the game.
+
+   @param guesses the guesses made by the player, in order.
+
+   @param num_guesses the number of items in `guesses`.
+
+   @returns 1 if the game was added, 0 if the answer or any guess is
+   not a valid word, or -1 if memory could not be allocated.
+ */
+int detector_add_game(detector_t *detector, const char player[], const char answer[],
+                      const char *guesses[], unsigned int num_guesses) {
+  packed_word_t packed[MAX_NUM_ATTEMPTS];
+  game_metrics_t metrics;
+
+  if (num_guesses == 0 || num_guesses > MAX_NUM_ATTEMPTS) return 0;
+  for (unsigned int i = 0; i < num_guesses; i++) {
+    if (!yk_dict_contains(detector->dict, guesses[i])) return 0;
+    packed[i] = pack_word(guesses[i]);
+  }
+
+  if (!game_metrics(detector, pack_word(answer), packed, num_guesses, &metrics)) return 0;
+
+  player_record_t *record = find_player(detector, player);
+  if (record == NULL) return -1;
+
+  record->num_games++;
+  record->excess_bits += metrics.gained_bits - metrics.expected_bits;
+  record->variance += metrics.variance;
+  return 1;
+}
+
+/**
+   @returns how many standard deviations the information gained by a
+   player is above what is expected from a player who does not know
+   the answers.
+ */
+double player_score(const player_record_t *record) {
+  if (record->variance <= 0) return 0;
+  return record->excess_bits / sqrt(record->variance);
+}
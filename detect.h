@@ -0,0 +1,50 @@
+#pragma once
+
+#include "engine.h"
+
+/* Players whose score (see `player_score`) is at least this high are
+   flagged as suspicious. */
+#define DETECT_THRESHOLD 4.0
+
+typedef struct game_metrics {
+
+  /** Information, in bits, the guesses were expected to give and
+      actually gave, summed over all guesses. */
+  double expected_bits;
+  double gained_bits;
+
+  /** Variance of `gained_bits` for a player who does not know the
+      answer, summed over all guesses. */
+  double variance;
+} game_metrics_t;
+
+typedef struct player_record {
+  char *name;
+  unsigned int num_games;
+
+  /** Sums of `gained_bits - expected_bits` and of `variance` over all
+      games of the player. */
+  double excess_bits;
+  double variance;
+} player_record_t;
+
+typedef struct detector {
+  const yk_dict_t *dict;
+
+  /** Scratch buffers for candidates and their feedback patterns. */
+  packed_word_t *candidates;
+  pattern_t *patterns;
+
+  /** Open-addressing table of players, indexed by a hash of their
+      names. Empty slots have a NULL name. */
+  player_record_t *players;
+  unsigned int num_players;
+  unsigned int capacity;
+} detector_t;
+
+int game_metrics(detector_t *, packed_word_t, const packed_word_t[], unsigned int, game_metrics_t *);
+
+int detector_init(detector_t *, const yk_dict_t *);
+void detector_free(detector_t *);
+int detector_add_game(detector_t *, const char[], const char[], const char *[], unsigned int);
+double player_score(const player_record_t *);
@@ -0,0 +1,409 @@
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+
+#include "engine.h"
+
+/* The functions in this file make up the game engine. They do not
+   perform any I/O and do not keep any global state, so they can be
+   used from any number of threads as long as each game is only used
+   by one thread at a time. */
+
+/**
+   Compares the guessed word with the correct answer, completing the
+   result array according to the expected values:
+    
+   - If the letter at position i of the guess matches the
+     corresponding letter in the same position in the answer, then
+     `result[i]` is set to LR_IN_PLACE;
+
+   - If the letter at position i of the guess matches some letter in
+     the answer, but at a different position, then `result[i]` is set
+     to LR_WRONG_PLACE;
+
+   - If none of the matches above are correct, `result[i] is set to
+     LR_INCORRECT.
+
+   Note that, if the guess or answer have repeated letters,
+   LR_IN_PLACE takes precedence if there is a match, and
+   LR_WRONG_PLACE may only be used if the corresponding letter in the
+   answer must not have been matched with another letter in the guess.
+
+   Example: if the answer is `bread` and the guess is `erase`, index 1
+   gets LR_IN_PLACE (R matches), indices 0 and 2 get LR_WRONG_PLACE (E
+   and A are in the answer), index 3 gets LR_INCORRECT (there is no S)
+   and index 4 gets LR_INCORRECT (there is an E, but it is matched by
+   index 0).
+
+   Another example: if the answer is `blood`, and the guess is
+   `boron`, indices 0 and 3 get LR_IN_PLACE (B and the last O match),
+   LR_WRONG_PLACE in index 1 (there is another unmatched O in the
+   answer, but not at this position) and LR_INCORRECT in indices 2 and
+   4 (since there is no R or N in the answer).
+
+   @param todays_answer the answer to be compared against the guessed
+   attempt.
+
+   @param attempt the word guessed by the player.
+   
+   @param result an array where the results of each letter are
+   stored. Must have space for WORD_SIZE elements.
+
+   @returns a non-zero value if all letters match with LR_IN_PLACE,
+   and zero otherwise. The result is always updated, regardless of the
+   return value.
+ */
+int compare_result(const char todays_answer[], const char attempt[], letter_result_t result[]) {
+  int out = 1; // non-zero value indicates correct attempt and 0 otherwise
+
+  // make a copy of todays_answer
+  char todays_answer_copy[WORD_SIZE];
+  for (int i = 0; i < WORD_SIZE; i++) {
+    todays_answer_copy[i] = todays_answer[i];
+  }
+
+  for (int i = 0; i < WORD_SIZE; i++) {
+    if (attempt[i] == todays_answer[i]) {
+      result[i] = LR_IN_PLACE;
+      todays_answer_copy[i] = '!';
+    } else {
+      out = 0;
+      result[i] = LR_INCORRECT;
+    }
+  }  
+
+  for (int i = 0; i < WORD_SIZE; i++) {
+    for (int j = 0; j < WORD_SIZE; j++) {
+      if (attempt[i] == todays_answer_copy[j] && result[i] != 2) {
+        result[i] = LR_WRONG_PLACE;
+        todays_answer_copy[j] = '!';
+        break;
+      }
+    }
+  }
+
+  return out;
+}
+
+static int compare_keys(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+  return (x > y) - (x < y);
+}
+
+/**
+   Builds a dictionary from words in a memory buffer. Words are
+   separated by spaces or line breaks, as in the file words.txt. Words
+   that do not have exactly WORD_SIZE lowercase letters are skipped,
+   and repeated words are only stored once. There is no limit on the
+   number of words.
+
+   @param dict the struct to be initialized. Must be released with
+   `yk_dict_free` if this function succeeds.
+
+   @param buffer the text containing the words. Does not need to be
+   zero-terminated.
+
+   @param length the number of bytes in `buffer`.
+
+   @returns a non-zero value if the dictionary was loaded, or zero if
+   memory could not be allocated.
+ */
+int yk_dict_load(yk_dict_t *dict, const char buffer[], size_t length) {
+  unsigned int capacity = length / (WORD_SIZE + 1) + 1;
+  uint64_t *sorted = NULL;
+  char (*text)[WORD_SIZE + 1] = NULL;
+  const char **strings = NULL;
+  unsigned int num_words = 0;
+  int result = 0;
+
+  dict->num_words = 0;
+  dict->words = malloc(capacity * sizeof(*dict->words));
+  if (dict->words == NULL) return 0;
+
+  size_t i = 0;
+  while (i < length) {
+    while (i < length && isspace((unsigned char) buffer[i])) i++;
+    size_t start = i;
+    while (i < length && !isspace((unsigned char) buffer[i])) i++;
+    if (i - start != WORD_SIZE) continue;
+
+    char word[WORD_SIZE + 1];
+    memcpy(word, buffer + start, WORD_SIZE);
+    word[WORD_SIZE] = '\0';
+
+    packed_word_t packed = pack_word(word);
+    if (packed != 0) dict->words[num_words++] = packed;
+  }
+
+  /* Repeated words are found by sorting the words along with their
+     positions, and all but the first occurrence are removed. The
+     sorted words are then the input of the DAWG. */
+  sorted = malloc((num_words ? num_words : 1) * sizeof(*sorted));
+  text = malloc((num_words ? num_words : 1) * sizeof(*text));
+  strings = malloc((num_words ? num_words : 1) * sizeof(*strings));
+  if (sorted == NULL || text == NULL || strings == NULL) goto done;
+
+  for (unsigned int w = 0; w < num_words; w++) sorted[w] = (uint64_t) dict->words[w] << 32 | w;
+  qsort(sorted, num_words, sizeof(*sorted), compare_keys);
+
+  unsigned int num_unique = 0;
+  for (unsigned int w = 0; w < num_words; w++) {
+    if (w > 0 && sorted[w] >> 32 == sorted[w - 1] >> 32) {
+      dict->words[(uint32_t) sorted[w]] = 0;
+      continue;
+    }
+    unpack_word(sorted[w] >> 32, text[num_unique]);
+    strings[num_unique] = text[num_unique];
+    num_unique++;
+  }
+  for (unsigned int w = 0; w < num_words; w++)
+    if (dict->words[w] != 0) dict->words[dict->num_words++] = dict->words[w];
+
+  result = dawg_build(&dict->valid, strings, num_unique);
+
+ done:
+  free(sorted);
+  free(text);
+  free(strings);
+  if (!result) {
+    free(dict->words);
+    dict->words = NULL;
+    dict->num_words = 0;
+  }
+  return result;
+}
+
+/**
+   Releases the memory used by a dictionary loaded with
+   `yk_dict_load`.
+ */
+void yk_dict_free(yk_dict_t *dict) {
+  free(dict->words);
+  dict->words = NULL;
+  dict->num_words = 0;
+  dawg_free(&dict->valid);
+}
+
+/**
+   Computes a 64-bit FNV-1a hash of the words in a dictionary, in
+   order. Results computed from different dictionaries can be told
+   apart by comparing hashes.
+
+   @returns the hash of `dict`.
+ */
+uint64_t yk_dict_hash(const yk_dict_t *dict) {
+  uint64_t hash = 0xcbf29ce484222325u;
+
+  for (unsigned int i = 0; i < dict->num_words; i++) {
+    for (int shift = 0; shift < 32; shift += 8) {
+      hash ^= (dict->words[i] >> shift) & 0xff;
+      hash *= 0x100000001b3u;
+    }
+  }
+  return hash;
+}
+
+/**
+   Checks if a word is in the dictionary.
+
+   @returns a non-zero value if `word` is in the dictionary, or zero
+   otherwise.
+ */
+int yk_dict_contains(const yk_dict_t *dict, const char word[]) {
+  return dawg_contains(&dict->valid, word);
+}
+
+/**
+   Builds the table of the feedback every word in a dictionary gets
+   against one answer. Games started with `yk_game_init_daily` then
+   handle each guess with a single lookup, which both validates it and
+   gives its feedback: the walk down the DAWG of the dictionary that
+   validates the guess also numbers it, and the number selects its
+   pattern in a table of one byte per word (about 15 KB for words.txt).
+   Building the table scores every word once, so it pays off when many
+   games share the same answer, e.g., everyone playing on the same
+   day.
+
+   @param daily the struct to be initialized. Must be released with
+   `yk_daily_free` if this function succeeds.
+
+   @param dict the dictionary of valid guesses. Must not be released
+   while the table is in use.
+
+   @param answer the answer the words are scored against.
+
+   @returns a non-zero value if the table was built, or zero if memory
+   could not be allocated or `answer` does not have exactly WORD_SIZE
+   lowercase letters (errno is set to EINVAL).
+ */
+int yk_daily_build(yk_daily_t *daily, const yk_dict_t *dict, const char answer[]) {
+  packed_word_t packed_answer = pack_word(answer);
+  if (packed_answer == 0) {
+    errno = EINVAL;
+    return 0;
+  }
+
+  pattern_t *patterns = malloc(dict->num_words + 1);
+  daily->patterns = malloc(dict->num_words + 1);
+  if (patterns == NULL || daily->patterns == NULL) {
+    free(patterns);
+    free(daily->patterns);
+    daily->patterns = NULL;
+    return 0;
+  }
+
+  daily->dict = dict;
+  memcpy(daily->answer, answer, WORD_SIZE + 1);
+
+  batch_score_guesses(dict->words, dict->num_words, packed_answer, patterns);
+  for (unsigned int i = 0; i < dict->num_words; i++) {
+    char word[WORD_SIZE + 1];
+    unpack_word(dict->words[i], word);
+    daily->patterns[dawg_index(&dict->valid, word)] = patterns[i];
+  }
+
+  free(patterns);
+  return 1;
+}
+
+/**
+   Releases the memory used by a table built with `yk_daily_build`.
+ */
+void yk_daily_free(yk_daily_t *daily) {
+  free(daily->patterns);
+  daily->patterns = NULL;
+}
+
+/**
+   Looks up a guess in a daily table.
+
+   @param word the packed guess. May be zero.
+
+   @param pattern where the feedback for `word` against the answer of
+   the table is stored, if it is a valid guess.
+
+   @returns a non-zero value if `word` is in the dictionary of the
+   table, or zero otherwise.
+ */
+int yk_daily_lookup(const yk_daily_t *daily, packed_word_t word, pattern_t *pattern) {
+  char letters[WORD_SIZE + 1];
+
+  if (word == 0) return 0;
+  unpack_word(word, letters);
+  long index = dawg_index(&daily->dict->valid, letters);
+  if (index < 0) return 0;
+  *pattern = daily->patterns[index];
+  return 1;
+}
+
+/**
+   Starts a new game.
+
+   @param game the struct where the game state is to be stored.
+
+   @param dict the dictionary of valid guesses. Must not be released
+   while the game is in use.
+
+   @param answer the correct answer for the game.
+
+   @returns a non-zero value if the game was started, or zero if
+   `answer` does not have exactly WORD_SIZE lowercase letters (errno is
+   set to EINVAL).
+ */
+int yk_game_init(yk_game_t *game, const yk_dict_t *dict, const char answer[]) {
+  if (pack_word(answer) == 0) {
+    errno = EINVAL;
+    return 0;
+  }
+
+  game->dict = dict;
+  game->daily = NULL;
+  memcpy(game->answer, answer, WORD_SIZE + 1);
+  game->num_attempts = 0;
+  game->solved = 0;
+  return 1;
+}
+
+/**
+   Starts a new game against the answer of a daily table. Guesses are
+   validated and scored with the table instead of being compared with
+   the answer.
+
+   @param game the struct where the game state is to be stored.
+
+   @param daily the table built with `yk_daily_build`. Must not be
+   released while the game is in use.
+
+   @returns a non-zero value.
+ */
+int yk_game_init_daily(yk_game_t *game, const yk_daily_t *daily) {
+  game->dict = daily->dict;
+  game->daily = daily;
+  memcpy(game->answer, daily->answer, WORD_SIZE + 1);
+  game->num_attempts = 0;
+  game->solved = 0;
+  return 1;
+}
+
+/**
+   Submits a guess in a game. Guesses that are not in the dictionary
+   are rejected and do not count as an attempt.
+
+   @param game the game state, updated with the guess.
+
+   @param guess the word guessed by the player.
+
+   @param result an array where the result of each letter is stored,
+   as in `compare_result`. Must have space for WORD_SIZE elements. Not
+   changed if the guess is rejected. May be NULL.
+
+   @returns YK_GUESS_INVALID if the guess is not a valid word,
+   YK_GAME_OVER if the game had already finished, YK_GUESS_SOLVED if
+   the guess matches the answer, or YK_GUESS_WRONG otherwise.
+ */
+yk_guess_status_t yk_game_submit(yk_game_t *game, const char guess[], letter_result_t result[]) {
+  if (yk_game_finished(game)) return YK_GAME_OVER;
+
+  pattern_t pattern;
+  if (game->daily != NULL) {
+    if (!yk_daily_lookup(game->daily, pack_word(guess), &pattern)) return YK_GUESS_INVALID;
+  } else if (!yk_dict_contains(game->dict, guess)) {
+    return YK_GUESS_INVALID;
+  }
+
+  unsigned int attempt = game->num_attempts++;
+  memcpy(game->guesses[attempt], guess, WORD_SIZE + 1);
+  if (game->daily != NULL) {
+    pattern_to_result(pattern, game->results[attempt]);
+    game->solved = pattern == PATTERN_SOLVED;
+  } else {
+    game->solved = compare_result(game->answer, guess, game->results[attempt]);
+  }
+
+  if (result != NULL) memcpy(result, game->results[attempt], sizeof(game->results[attempt]));
+
+  return game->solved ? YK_GUESS_SOLVED : YK_GUESS_WRONG;
+}
+
+/**
+   @returns a non-zero value if the answer was found or all attempts
+   were used, or zero otherwise.
+ */
+int yk_game_finished(const yk_game_t *game) {
+  return game->solved || game->num_attempts >= MAX_NUM_ATTEMPTS;
+}
+
+/**
+   Gets the result of a finished game, in the form expected by
+   `save_stats`.
+
+   @returns the number of attempts needed to find the answer,
+   MAX_NUM_ATTEMPTS+1 if the answer was not found, or zero if the game
+   has not finished.
+ */
+unsigned int yk_game_result(const yk_game_t *game) {
+  if (game->solved) return game->num_attempts;
+  if (game->num_attempts >= MAX_NUM_ATTEMPTS) return MAX_NUM_ATTEMPTS + 1;
+  return 0;
+}
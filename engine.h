@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game.h"
+#include "batch.h"
+#include "dawg.h"
+
+typedef struct yk_dict {
+
+  /** Words accepted as guesses, packed, in the order they were
+      loaded. Only the first `num_words` words are considered. */
+  packed_word_t *words;
+
+  /** Number of items in `words`. */
+  unsigned int num_words;
+
+  /** Minimized DAWG containing all items in `words`, used for
+      validation and to number the words for daily tables. Its size
+      grows with the number of words, and shrinks with how many
+      prefixes and suffixes they share: about 9 bytes per word for
+      words.txt. */
+  dawg_t valid;
+} yk_dict_t;
+
+typedef struct yk_daily {
+
+  /** Dictionary the table was built from. */
+  const yk_dict_t *dict;
+
+  /** The answer every guess in the table was scored against. */
+  char answer[WORD_SIZE + 1];
+
+  /** The pattern of every word in `dict` against `answer`, one byte
+      per word, indexed by the position of the word in `dict->valid`
+      as given by `dawg_index`. */
+  pattern_t *patterns;
+} yk_daily_t;
+
+typedef struct yk_game {
+
+  /** Dictionary of valid guesses. Not modified by the game, so it may
+      be shared by any number of games, in any number of threads. */
+  const yk_dict_t *dict;
+
+  /** Table of the feedback for every valid guess against `answer`,
+      shared like `dict`, or NULL if guesses are scored as they are
+      submitted. */
+  const yk_daily_t *daily;
+
+  /** The correct answer, as a string. */
+  char answer[WORD_SIZE + 1];
+
+  /** Number of valid guesses submitted so far. */
+  unsigned int num_attempts;
+
+  /** Non-zero if the last guess matched the answer. */
+  int solved;
+
+  /** Guesses submitted so far, and the result of each of them. Only
+      the first `num_attempts` entries are set. */
+  char guesses[MAX_NUM_ATTEMPTS][WORD_SIZE + 1];
+  letter_result_t results[MAX_NUM_ATTEMPTS][WORD_SIZE];
+} yk_game_t;
+
+typedef enum {
+  YK_GUESS_INVALID = 0,
+  YK_GUESS_WRONG,
+  YK_GUESS_SOLVED,
+  YK_GAME_OVER
+} yk_guess_status_t;
+
+int compare_result(const char[], const char[], letter_result_t[]);
+
+int yk_dict_load(yk_dict_t *, const char[], size_t);
+void yk_dict_free(yk_dict_t *);
+int yk_dict_contains(const yk_dict_t *, const char[]);
+uint64_t yk_dict_hash(const yk_dict_t *);
+
+int yk_daily_build(yk_daily_t *, const yk_dict_t *, const char[]);
+void yk_daily_free(yk_daily_t *);
+int yk_daily_lookup(const yk_daily_t *, packed_word_t, pattern_t *);
+
+int yk_game_init(yk_game_t *, const yk_dict_t *, const char[]);
+int yk_game_init_daily(yk_game_t *, const yk_daily_t *);
+yk_guess_status_t yk_game_submit(yk_game_t *, const char[], letter_result_t[]);
+int yk_game_finished(const yk_game_t *);
+unsigned int yk_game_result(const yk_game_t *);
@@ -0,0 +1,606 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "exact.h"
+#include "parallel.h"
+
+/* Exact search for the strategy that finds the answers of a pool with
+   the fewest guesses in total, i.e., on average. The cost of a set of
+   candidates is the number of guesses needed to find each of them,
+   added up; the best guess for a set is the one minimizing the size
+   of the set (the guess itself, made for every candidate) plus the
+   cost of each set it splits the candidates into, except for the one
+   where the guess was the answer.
+
+   The search is a depth-first branch and bound. Guesses are tried in
+   order of a lower bound of their cost, and given up on as soon as
+   their bound, refined as their sets are solved, reaches the best
+   cost found so far. Sets already solved are remembered by a hash of
+   their contents, together with their best guess, or with a lower
+   bound of their cost if the search was cut short. Top-level guesses
+   are searched in parallel. */
+
+/* Number of consecutive slots a set may be stored in, starting from
+   the slot given by its hash. */
+#define MEMO_WAYS 8
+
+/* Number of locks protecting the table of solved sets; each lock
+   protects a range of slots. */
+#define MEMO_LOCKS 64
+
+/* Guess index used in the table of solved sets for a lower bound. */
+#define NO_GUESS UINT32_MAX
+
+typedef struct memo_entry {
+  uint64_t key[2];
+  uint32_t cost;
+
+  /** Best guess for the set, as a position in the guesses, or
+      NO_GUESS if `cost` is only a lower bound. */
+  uint32_t guess;
+} memo_entry_t;
+
+typedef struct ranked_guess {
+  uint32_t bound;
+  uint32_t score;
+  uint32_t index;
+  int is_candidate;
+} ranked_guess_t;
+
+typedef struct exact {
+  const packed_word_t *guesses;
+  unsigned int num_guesses;
+  const packed_word_t *answers;
+  unsigned int num_answers;
+
+  /* The pattern of every guess against every answer, one row per
+     guess, and the position of each answer in the guesses. */
+  pattern_t *patterns;
+  uint32_t *answer_guess;
+
+  memo_entry_t *memo;
+  pthread_mutex_t locks[MEMO_LOCKS];
+  uint64_t num_nodes;
+
+  /* Top-level guesses, searched in parallel, their costs, and the
+     lowest cost found so far. */
+  const uint32_t *root;
+  unsigned int root_size;
+  ranked_guess_t *root_guesses;
+  uint32_t *root_costs;
+  uint32_t best_cost;
+
+  /* Set if memory could not be allocated. */
+  int failed;
+} exact_t;
+
+/**
+   @returns a lower bound of the cost of `size` candidates. At best,
+   the first guess is one of them, and splits the others into sets of
+   one, which need one more guess each; but there are only
+   NUM_PATTERNS-1 such sets, and candidates beyond those need at least
+   one more guess.
+ */
+static uint32_t size_bound(unsigned int size) {
+  if (size == 0) return 0;
+  return 2 * size - 1 + (size > NUM_PATTERNS ? size - NUM_PATTERNS : 0);
+}
+
+static void set_key(const uint32_t set[], unsigned int size, uint64_t key[]) {
+  uint64_t a = 0x9e3779b97f4a7c15u ^ size, b = 0xc2b2ae3d27d4eb4fu + size;
+
+  for (unsigned int i = 0; i < size; i++) {
+    a = (a ^ set[i]) * 0x100000001b3u;
+    b = (b + set[i] + 1) * 0xff51afd7ed558ccdu;
+    b ^= b >> 29;
+  }
+  key[0] = a;
+  key[1] = b;
+}
+
+/* Finds the first slot where a set may be stored, and its lock. */
+static memo_entry_t *memo_group(exact_t *exact, const uint64_t key[], pthread_mutex_t **lock) {
+  size_t slot = (key[0] ^ key[1] >> 17) & (EXACT_MEMO_SIZE - 1) & ~(size_t) (MEMO_WAYS - 1);
+  *lock = &exact->locks[slot / MEMO_WAYS % MEMO_LOCKS];
+  return &exact->memo[slot];
+}
+
+static int memo_get(exact_t *exact, const uint64_t key[], memo_entry_t *found) {
+  pthread_mutex_t *lock;
+  memo_entry_t *group = memo_group(exact, key, &lock);
+  int result = 0;
+
+  pthread_mutex_lock(lock);
+  for (int i = 0; i < MEMO_WAYS; i++) {
+    if (group[i].key[0] == key[0] && group[i].key[1] == key[1] && group[i].cost != 0) {
+      *found = group[i];
+      result = 1;
+      break;
+    }
+  }
+  pthread_mutex_unlock(lock);
+  return result;
+}
+
+/* Stores what is known about a set. Exact costs are never replaced by
+   bounds. When the group is full, a slot is replaced based on the
+   key, so that entries do not all compete for the same slot. */
+static void memo_put(exact_t *exact, const uint64_t key[], uint32_t cost, uint32_t guess) {
+  pthread_mutex_t *lock;
+  memo_entry_t *group = memo_group(exact, key, &lock);
+  memo_entry_t *slot = &group[key[1] % MEMO_WAYS];
+
+  pthread_mutex_lock(lock);
+  for (int i = 0; i < MEMO_WAYS; i++) {
+    if (group[i].key[0] == key[0] && group[i].key[1] == key[1]) {
+      slot = &group[i];
+      break;
+    }
+    if (group[i].cost == 0) slot = &group[i];
+  }
+  if (!(slot->key[0] == key[0] && slot->key[1] == key[1] && slot->guess != NO_GUESS && guess == NO_GUESS))
+    *slot = (memo_entry_t) { { key[0], key[1] }, cost, guess };
+  pthread_mutex_unlock(lock);
+}
+
+static int compare_ranked(const void *a, const void *b) {
+  const ranked_guess_t *x = a, *y = b;
+  if (x->bound != y->bound) return x->bound < y->bound ? -1 : 1;
+  if (x->score != y->score) return x->score < y->score ? -1 : 1;
+  if (x->is_candidate != y->is_candidate) return x->is_candidate ? -1 : 1;
+  return x->index < y->index ? -1 : x->index > y->index;
+}
+
+/**
+   Looks for a candidate that gives different feedback for every
+   candidate. Guessing it reaches `size_bound`, so it is the best
+   guess.
+
+   @returns the position of the first such candidate in the guesses,
+   or NO_GUESS if there is none.
+ */
+static uint32_t perfect_candidate(const exact_t *exact, const uint32_t set[], unsigned int size) {
+  if (size > NUM_PATTERNS) return NO_GUESS;
+
+  for (unsigned int c = 0; c < size; c++) {
+    uint32_t guess = exact->answer_guess[set[c]];
+    const pattern_t *row = exact->patterns + (size_t) guess * exact->num_answers;
+    uint64_t seen[(NUM_PATTERNS + 63) / 64] = { 0 };
+    unsigned int i;
+
+    for (i = 0; i < size; i++) {
+      uint64_t bit = UINT64_C(1) << (row[set[i]] % 64);
+      if (seen[row[set[i]] / 64] & bit) break;
+      seen[row[set[i]] / 64] |= bit;
+    }
+    if (i == size) return guess;
+  }
+  return NO_GUESS;
+}
+
+typedef struct seen_split {
+  uint64_t hash;
+  uint32_t guess;
+} seen_split_t;
+
+/**
+   @returns whether two guesses give the same feedback for every
+   candidate in a set, and so split it the same way.
+ */
+static int same_split(const exact_t *exact, const uint32_t set[], unsigned int size, uint32_t a, uint32_t b) {
+  const pattern_t *row_a = exact->patterns + (size_t) a * exact->num_answers;
+  const pattern_t *row_b = exact->patterns + (size_t) b * exact->num_answers;
+
+  for (unsigned int i = 0; i < size; i++)
+    if (row_a[set[i]] != row_b[set[i]]) return 0;
+  return 1;
+}
+
+/**
+   Gives every guess a lower bound of its cost for a set of candidates
+   and sorts them by it. Guesses that do not split the set, and guesses
+   that split it the same way as one listed before, are left out.
+
+   @param ranked where the guesses are stored. Must have space for
+   `exact->num_guesses` elements.
+
+   @returns the number of guesses stored, or zero if memory could not
+   be allocated.
+ */
+static unsigned int rank_guesses(const exact_t *exact, const uint32_t set[], unsigned int size,
+                                 ranked_guess_t ranked[]) {
+  unsigned int counts[NUM_PATTERNS] = { 0 };
+  pattern_t used[NUM_PATTERNS];
+  unsigned int num_ranked = 0;
+
+  /* Hashes of the splits seen so far, and the guess that made each,
+     to skip repeated ones. */
+  unsigned int num_slots = 16;
+  while (num_slots < 2 * exact->num_guesses) num_slots *= 2;
+  seen_split_t *seen = calloc(num_slots, sizeof(*seen));
+  if (seen == NULL) return 0;
+
+  for (unsigned int g = 0; g < exact->num_guesses; g++) {
+    const pattern_t *row = exact->patterns + (size_t) g * exact->num_answers;
+    unsigned int num_used = 0, largest = 0;
+    uint64_t hash = 0x84222325cbf29ce4u;
+
+    for (unsigned int i = 0; i < size; i++) {
+      pattern_t pattern = row[set[i]];
+      used[num_used] = pattern;
+      num_used += counts[pattern]++ == 0;
+      hash = (hash ^ pattern) * 0x100000001b3u;
+    }
+
+    ranked_guess_t *entry = &ranked[num_ranked];
+    entry->bound = size;
+    entry->score = 0;
+    entry->index = g;
+    entry->is_candidate = counts[PATTERN_SOLVED] > 0;
+    for (unsigned int u = 0; u < num_used; u++) {
+      unsigned int count = counts[used[u]];
+      if (count > largest) largest = count;
+      if (used[u] != PATTERN_SOLVED) {
+        entry->bound += size_bound(count);
+        entry->score += count * count;
+      }
+      counts[used[u]] = 0;
+    }
+    if (largest == size && !entry->is_candidate) continue;
+
+    hash |= 1;
+    unsigned int slot = hash & (num_slots - 1);
+    while (seen[slot].hash != 0
+           && (seen[slot].hash != hash || !same_split(exact, set, size, seen[slot].guess, g)))
+      slot = (slot + 1) & (num_slots - 1);
+    if (seen[slot].hash != 0) continue;
+    seen[slot].hash = hash;
+    seen[slot].guess = g;
+    num_ranked++;
+  }
+
+  free(seen);
+  qsort(ranked, num_ranked, sizeof(*ranked), compare_ranked);
+  return num_ranked;
+}
+
+static uint32_t solve_set(exact_t *exact, const uint32_t set[], unsigned int size, uint32_t limit, uint32_t *guess);
+
+/**
+   Computes the cost of a guess for a set of candidates, giving up
+   once it reaches `limit`.
+
+   @returns the cost of the guess if it is below `limit`, or else a
+   value of at least `limit`. Zero if memory could not be allocated.
+ */
+static uint32_t guess_cost(exact_t *exact, const uint32_t set[], unsigned int size, uint32_t guess, uint32_t limit) {
+  const pattern_t *row = exact->patterns + (size_t) guess * exact->num_answers;
+  unsigned int counts[NUM_PATTERNS] = { 0 }, starts[NUM_PATTERNS + 1], next[NUM_PATTERNS];
+  uint32_t cost = size, rest = 0;
+
+  uint32_t *sorted = malloc(size * sizeof(*sorted));
+  if (sorted == NULL) return 0;
+
+  for (unsigned int i = 0; i < size; i++) counts[row[set[i]]]++;
+  starts[0] = 0;
+  for (int p = 0; p < NUM_PATTERNS; p++) {
+    starts[p + 1] = starts[p] + counts[p];
+    if (p != PATTERN_SOLVED) rest += size_bound(counts[p]);
+  }
+  memcpy(next, starts, sizeof(next));
+  for (unsigned int i = 0; i < size; i++) sorted[next[row[set[i]]]++] = set[i];
+  counts[PATTERN_SOLVED] = 0;
+
+  /* Large sets first: they are the most likely to exceed their bound,
+     which ends the search for this guess early. */
+  while (cost + rest < limit) {
+    int largest = -1;
+    for (int p = 0; p < NUM_PATTERNS; p++)
+      if (counts[p] > 0 && (largest < 0 || counts[p] > counts[largest])) largest = p;
+    if (largest < 0) break;
+
+    rest -= size_bound(counts[largest]);
+    uint32_t child = solve_set(exact, sorted + starts[largest], counts[largest], limit - cost - rest, NULL);
+    if (child == 0) {
+      cost = 0;
+      break;
+    }
+    cost += child;
+    counts[largest] = 0;
+  }
+
+  free(sorted);
+  return cost == 0 ? 0 : cost + rest;
+}
+
+/**
+   Finds the lowest cost of a set of candidates, sorted by position in
+   the answers, if it is below `limit`.
+
+   @param guess where the best guess is stored, as a position in the
+   guesses, if the cost is below `limit`. May be NULL.
+
+   @returns the lowest cost if it is below `limit`, or else a value of
+   at least `limit`. Zero if memory could not be allocated.
+ */
+static uint32_t solve_set(exact_t *exact, const uint32_t set[], unsigned int size, uint32_t limit, uint32_t *guess) {
+  uint64_t key[2];
+  memo_entry_t known;
+  uint32_t best = limit, best_guess = NO_GUESS;
+
+  if (size <= 2) {
+    if (guess != NULL) *guess = exact->answer_guess[set[0]];
+    return size_bound(size);
+  }
+
+  set_key(set, size, key);
+  uint32_t bound = size_bound(size);
+  if (memo_get(exact, key, &known)) {
+    if (known.guess != NO_GUESS) {
+      if (guess != NULL && known.cost < limit) *guess = known.guess;
+      return known.cost;
+    }
+    if (known.cost > bound) bound = known.cost;
+  }
+  if (bound >= limit) return bound;
+
+  __atomic_fetch_add(&exact->num_nodes, 1, __ATOMIC_RELAXED);
+
+  best_guess = perfect_candidate(exact, set, size);
+  if (best_guess != NO_GUESS) {
+    best = size_bound(size);
+  } else {
+    ranked_guess_t *ranked = malloc(exact->num_guesses * sizeof(*ranked));
+    unsigned int num_ranked = ranked ? rank_guesses(exact, set, size, ranked) : 0;
+    if (num_ranked == 0) {
+      free(ranked);
+      return 0;
+    }
+
+    for (unsigned int r = 0; r < num_ranked && ranked[r].bound < best; r++) {
+      uint32_t cost = guess_cost(exact, set, size, ranked[r].index, best);
+      if (cost == 0) {
+        free(ranked);
+        return 0;
+      }
+      if (cost < best) {
+        best = cost;
+        best_guess = ranked[r].index;
+      }
+    }
+    free(ranked);
+  }
+
+  if (best_guess != NO_GUESS) {
+    memo_put(exact, key, best, best_guess);
+    if (guess != NULL) *guess = best_guess;
+  } else {
+    memo_put(exact, key, best, NO_GUESS);
+  }
+  return best;
+}
+
+/**
+   Searches one top-level guess. Guesses that tie with the best are
+   searched fully, so that the choice among them does not depend on
+   the order in which tasks finish.
+ */
+static void solve_root(unsigned int task, void *data) {
+  exact_t *exact = data;
+  const ranked_guess_t *ranked = &exact->root_guesses[task];
+  uint32_t best = __atomic_load_n(&exact->best_cost, __ATOMIC_RELAXED);
+
+  exact->root_costs[task] = UINT32_MAX;
+  if (ranked->bound > best) return;
+
+  uint32_t limit = best == UINT32_MAX ? UINT32_MAX : best + 1;
+  uint32_t cost = guess_cost(exact, exact->root, exact->num_answers, ranked->index, limit);
+  if (cost == 0) {
+    __atomic_store_n(&exact->failed, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  if (cost >= limit) return;
+
+  exact->root_costs[task] = cost;
+  while (cost < best && !__atomic_compare_exchange_n(&exact->best_cost, &best, cost, 1,
+                                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+static void score_rows(unsigned int task, void *data) {
+  exact_t *exact = data;
+  unsigned int end = (task + 1) * 64;
+
+  if (end > exact->num_guesses) end = exact->num_guesses;
+  for (unsigned int g = task * 64; g < end; g++) {
+    pattern_t *row = exact->patterns + (size_t) g * exact->num_answers;
+    batch_score_answers(exact->guesses[g], exact->answers, exact->num_answers, row);
+    for (unsigned int a = 0; a < exact->num_answers; a++)
+      if (row[a] == PATTERN_SOLVED) exact->answer_guess[a] = g;
+  }
+}
+
+/**
+   Stores the guesses the strategy plays for every candidate in a set,
+   following the best guess of each set.
+
+   @returns a non-zero value on success, or zero if memory could not
+   be allocated or a path is longer than EXACT_MAX_DEPTH.
+ */
+static int build_paths(exact_t *exact, exact_strategy_t *strategy, const uint32_t set[], unsigned int size,
+                       const packed_word_t path[], unsigned int depth) {
+  uint32_t guess;
+  packed_word_t next_path[EXACT_MAX_DEPTH];
+  unsigned int counts[NUM_PATTERNS] = { 0 }, starts[NUM_PATTERNS + 1], next[NUM_PATTERNS];
+
+  if (size == 0) return 1;
+  if (depth >= EXACT_MAX_DEPTH || solve_set(exact, set, size, UINT32_MAX, &guess) == 0) return 0;
+
+  memcpy(next_path, path, depth * sizeof(*path));
+  next_path[depth] = exact->guesses[guess];
+
+  uint32_t *sorted = malloc(size * sizeof(*sorted));
+  if (sorted == NULL) return 0;
+
+  const pattern_t *row = exact->patterns + (size_t) guess * exact->num_answers;
+  for (unsigned int i = 0; i < size; i++) counts[row[set[i]]]++;
+  starts[0] = 0;
+  for (int p = 0; p < NUM_PATTERNS; p++) starts[p + 1] = starts[p] + counts[p];
+  memcpy(next, starts, sizeof(next));
+  for (unsigned int i = 0; i < size; i++) sorted[next[row[set[i]]]++] = set[i];
+
+  int result = 1;
+  for (int p = 0; p < NUM_PATTERNS && result; p++) {
+    if (counts[p] == 0) continue;
+    if (p == PATTERN_SOLVED) {
+      uint32_t answer = sorted[starts[p]];
+      memcpy(strategy->paths + (size_t) answer * EXACT_MAX_DEPTH, next_path, (depth + 1) * sizeof(*path));
+      strategy->num_guesses[answer] = depth + 1;
+      strategy->total_guesses += depth + 1;
+    } else {
+      result = build_paths(exact, strategy, sorted + starts[p], counts[p], next_path, depth + 1);
+    }
+  }
+
+  free(sorted);
+  return result;
+}
+
+/**
+   Computes the strategy that finds every answer of a pool with the
+   fewest guesses in total, and so on average, with a proof that none
+   does better: every other guess is either searched or shown by a
+   bound not to be better. Feedback is computed as in
+   `compare_result`. There is no limit on the number of guesses.
+
+   The cost grows very quickly with the size of the pool: pools of a
+   few dozen answers take moments, pools of hundreds may take hours.
+
+   @param guesses the words that may be guessed. Must include every
+   answer.
+
+   @param num_guesses the number of items in `guesses`.
+
+   @param answers the answer pool, without repeated words.
+
+   @param num_answers the number of items in `answers`. At most
+   EXACT_MAX_ANSWERS.
+
+   @param strategy where the strategy is stored. Must be released with
+   `exact_strategy_free` if this function succeeds. `answers` must not
+   be released while it is in use.
+
+   @returns a non-zero value if the strategy was found, or zero if
+   memory could not be allocated, or the pool is too large or has an
+   answer that is not in `guesses` (errno is set to EINVAL).
+ */
+int exact_solve(const packed_word_t guesses[], unsigned int num_guesses,
+                const packed_word_t answers[], unsigned int num_answers, exact_strategy_t *strategy) {
+  exact_t exact = { .guesses = guesses, .num_guesses = num_guesses, .answers = answers,
+                    .num_answers = num_answers, .best_cost = UINT32_MAX };
+  uint32_t *root = NULL;
+  int result = 0;
+
+  memset(strategy, 0, sizeof(*strategy));
+  strategy->answers = answers;
+  strategy->num_answers = num_answers;
+  if (num_answers == 0) return 1;
+  if (num_answers > EXACT_MAX_ANSWERS || num_guesses == 0) {
+    errno = EINVAL;
+    return 0;
+  }
+
+  for (int i = 0; i < MEMO_LOCKS; i++) pthread_mutex_init(&exact.locks[i], NULL);
+  exact.patterns = malloc((size_t) num_guesses * num_answers);
+  exact.answer_guess = malloc(num_answers * sizeof(*exact.answer_guess));
+  exact.memo = calloc(EXACT_MEMO_SIZE, sizeof(*exact.memo));
+  exact.root_guesses = malloc(num_guesses * sizeof(*exact.root_guesses));
+  exact.root_costs = malloc(num_guesses * sizeof(*exact.root_costs));
+  root = malloc(num_answers * sizeof(*root));
+  strategy->paths = malloc((size_t) num_answers * EXACT_MAX_DEPTH * sizeof(*strategy->paths));
+  strategy->num_guesses = malloc(num_answers * sizeof(*strategy->num_guesses));
+  if (exact.patterns == NULL || exact.answer_guess == NULL || exact.memo == NULL || exact.root_guesses == NULL
+      || exact.root_costs == NULL || root == NULL || strategy->paths == NULL || strategy->num_guesses == NULL)
+    goto done;
+
+  for (unsigned int a = 0; a < num_answers; a++) {
+    exact.answer_guess[a] = NO_GUESS;
+    root[a] = a;
+  }
+  parallel_run((num_guesses + 63) / 64, score_rows, &exact);
+  for (unsigned int a = 0; a < num_answers; a++) {
+    if (exact.answer_guess[a] == NO_GUESS) {
+      errno = EINVAL;
+      goto done;
+    }
+  }
+
+  exact.root = root;
+  if (num_answers > 2 && perfect_candidate(&exact, root, num_answers) == NO_GUESS) {
+    exact.num_nodes = 1;
+    exact.root_size = rank_guesses(&exact, root, num_answers, exact.root_guesses);
+    if (exact.root_size == 0) goto done;
+    parallel_run(exact.root_size, solve_root, &exact);
+    if (exact.failed) goto done;
+
+    /* The best top-level guess is stored like any other set, so that
+       the paths below start from it. */
+    int top = -1;
+    for (unsigned int i = 0; i < exact.root_size; i++)
+      if (exact.root_costs[i] != UINT32_MAX && (top < 0 || exact.root_costs[i] < exact.root_costs[top])) top = i;
+    if (top < 0) goto done;
+
+    uint64_t key[2];
+    set_key(root, num_answers, key);
+    memo_put(&exact, key, exact.root_costs[top], exact.root_guesses[top].index);
+  }
+
+  result = build_paths(&exact, strategy, root, num_answers, NULL, 0);
+  strategy->num_nodes = exact.num_nodes;
+
+ done:
+  for (int i = 0; i < MEMO_LOCKS; i++) pthread_mutex_destroy(&exact.locks[i]);
+  free(exact.patterns);
+  free(exact.answer_guess);
+  free(exact.memo);
+  free(exact.root_guesses);
+  free(exact.root_costs);
+  free(root);
+  if (!result) exact_strategy_free(strategy);
+  return result;
+}
+
+/**
+   Releases the memory used by a strategy found by `exact_solve`.
+ */
+void exact_strategy_free(exact_strategy_t *strategy) {
+  free(strategy->paths);
+  free(strategy->num_guesses);
+  strategy->paths = NULL;
+  strategy->num_guesses = NULL;
+}
+
+/**
+   Writes a strategy as text, one answer per line: the guesses played
+   until it is found, separated by spaces, the last being the answer.
+   For example:
+
+salet crony bread
+
+   @returns a non-zero value on success, or zero if the strategy could
+   not be written.
+ */
+int exact_write_strategy(FILE *fh, const exact_strategy_t *strategy) {
+  char word[WORD_SIZE + 1];
+
+  for (unsigned int a = 0; a < strategy->num_answers; a++) {
+    const packed_word_t *path = strategy->paths + (size_t) a * EXACT_MAX_DEPTH;
+    for (unsigned int i = 0; i < strategy->num_guesses[a]; i++) {
+      unpack_word(path[i], word);
+      if (fprintf(fh, i > 0 ? " %s" : "%s", word) < 0) return 0;
+    }
+    if (fputc('\n', fh) == EOF) return 0;
+  }
+  return 1;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "batch.h"
+
+/* Largest answer pool `exact_solve` accepts. The search is
+   exponential, so only small pools finish in reasonable time anyway,
+   and the pattern table grows with the pool. */
+#define EXACT_MAX_ANSWERS 4096
+
+/* Number of entries in the table of solved candidate sets. When it is
+   full, old entries are replaced. */
+#define EXACT_MEMO_SIZE (1u << 20)
+
+/* Longest sequence of guesses stored for one answer. */
+#define EXACT_MAX_DEPTH 16
+
+typedef struct exact_strategy {
+
+  /** The answer pool, as given to `exact_solve`. */
+  const packed_word_t *answers;
+  unsigned int num_answers;
+
+  /** For each answer, the guesses the strategy plays until it finds
+      it, the last one being the answer itself: `num_guesses[i]`
+      words from `paths[i * EXACT_MAX_DEPTH]`. */
+  packed_word_t *paths;
+  unsigned char *num_guesses;
+
+  /** Sum of `num_guesses` over all answers: the lowest possible, so
+      the average number of guesses is this over `num_answers`. */
+  uint64_t total_guesses;
+
+  /** Number of candidate sets whose best guess was searched for. */
+  uint64_t num_nodes;
+} exact_strategy_t;
+
+int exact_solve(const packed_word_t[], unsigned int, const packed_word_t[], unsigned int, exact_strategy_t *);
+void exact_strategy_free(exact_strategy_t *);
+int exact_write_strategy(FILE *, const exact_strategy_t *);
@@ -0,0 +1,10 @@
+#pragma once
+
+#define WORD_SIZE 5
+#define MAX_NUM_ATTEMPTS 6
+
+typedef enum {
+  LR_INCORRECT = 0,
+  LR_WRONG_PLACE,
+  LR_IN_PLACE
+} letter_result_t;
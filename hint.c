@@ -0,0 +1,210 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "hint.h"
+#include "solver.h"
+
+/**
+   @returns one bit for each distinct letter in a packed word.
+ */
+static uint32_t letter_mask(packed_word_t word) {
+  uint32_t mask = 0;
+  for (int i = 0; i < WORD_SIZE; i++) mask |= 1u << (((word >> (5 * i)) & 0x1f) - 1);
+  return mask;
+}
+
+/**
+   Adds `sign` to the count of each distinct letter of each word.
+ */
+static void count_letters(unsigned int counts[], const packed_word_t words[], unsigned int num_words, int sign) {
+  for (unsigned int w = 0; w < num_words; w++) {
+    uint32_t mask = letter_mask(words[w]);
+    while (mask) {
+      counts[__builtin_ctz(mask)] += sign;
+      mask &= mask - 1;
+    }
+  }
+}
+
+/**
+   Prepares the hints for a new game, where every word in the
+   dictionary may be the answer. The candidates and letter counts are
+   kept up to date by `hint_update`, so the first two hint levels are
+   given immediately. The best guess, the only costly hint, is only
+   searched for when it is asked for, so games where no hint is asked
+   for (e.g., in JSON mode) never pay for it.
+
+   @param engine the struct to be initialized. Must be released with
+   `hint_free` if this function succeeds.
+
+   @param dict the dictionary of valid guesses. Must not be released
+   while the engine is in use.
+
+   @returns a non-zero value if the engine was initialized, or zero if
+   memory could not be allocated.
+ */
+int hint_init(hint_engine_t *engine, const yk_dict_t *dict) {
+  return hint_init_book(engine, dict, NULL);
+}
+
+/**
+   Same as `hint_init`, but takes the best first and second guesses
+   from an opening book instead of searching for them.
+
+   @param book the opening book, or NULL. Ignored if it was computed
+   for another dictionary. Must not be released while the engine is in
+   use.
+ */
+int hint_init_book(hint_engine_t *engine, const yk_dict_t *dict, const opening_book_t *book) {
+  engine->dict = dict;
+  if (!histogram_set_init(&engine->histograms, dict->words, dict->num_words, dict->words, dict->num_words))
+    return 0;
+
+  engine->book = book != NULL && book->dict_hash == yk_dict_hash(dict) ? book : NULL;
+  engine->first_guess = engine->book != NULL ? engine->book->first_guess : 0;
+  hint_reset(engine);
+  return 1;
+}
+
+/**
+   Prepares the hints for another game with the same dictionary,
+   without searching for the best first guess again.
+
+   @param engine the hint state, initialized with `hint_init`.
+ */
+void hint_reset(hint_engine_t *engine) {
+  const yk_dict_t *dict = engine->dict;
+
+  histogram_set_reset(&engine->histograms, dict->words, dict->num_words);
+  engine->num_candidates = dict->num_words;
+  engine->known_letters = 0;
+  engine->level = 0;
+  engine->num_guesses = 0;
+
+  memset(engine->letter_counts, 0, sizeof(engine->letter_counts));
+  count_letters(engine->letter_counts, dict->words, dict->num_words, 1);
+
+  engine->best_guess = engine->first_guess;
+}
+
+void hint_free(hint_engine_t *engine) {
+  engine->num_candidates = 0;
+  histogram_set_free(&engine->histograms);
+}
+
+/**
+   Updates the hints after the feedback for a guess. Candidates that
+   do not match the feedback are removed, once, by the histogram set,
+   and the letter counts are adjusted by whichever is cheaper:
+   subtracting the removed words, or counting the remaining ones
+   again. The best second guess is taken from the opening book, if
+   there is one and the first guess was the book's; any other best
+   guess is left to be searched for when asked for.
+
+   @param engine the hint state to be updated.
+
+   @param guess the word guessed by the player.
+
+   @param result the result of the guess, as set by `compare_result`.
+
+   @returns a non-zero value if the hints were updated, or zero if the
+   guess is not a valid word.
+ */
+int hint_update(hint_engine_t *engine, const char guess[], const letter_result_t result[]) {
+  histogram_set_t *set = &engine->histograms;
+  packed_word_t packed = pack_word(guess);
+  pattern_t wanted = pattern_from_result(result);
+  unsigned int total = engine->num_candidates;
+
+  if (packed == 0) return 0;
+
+  for (int i = 0; i < WORD_SIZE; i++)
+    if (result[i] != LR_INCORRECT) engine->known_letters |= 1u << (guess[i] - 'a');
+
+  unsigned int num_kept = histogram_set_update(set, packed, wanted);
+  if (total - num_kept < num_kept) {
+    count_letters(engine->letter_counts, set->removed, total - num_kept, -1);
+  } else {
+    memset(engine->letter_counts, 0, sizeof(engine->letter_counts));
+    count_letters(engine->letter_counts, set->candidates, num_kept, 1);
+  }
+  engine->num_candidates = num_kept;
+
+  if (engine->num_guesses++ == 0) {
+    engine->first_played = packed;
+    engine->first_pattern = wanted;
+  }
+  engine->best_guess = opening_book_guess(engine->book, engine->num_guesses, engine->first_played,
+                                          engine->first_pattern);
+  engine->level = 0;
+  return 1;
+}
+
+/**
+   Searches for the best guess for the current candidates. Once there
+   are few candidates, the histograms are cheap to build and then
+   cheap to keep up to date, and give the exact best guess without
+   sampling.
+
+   @returns the best guess, or zero if memory could not be allocated.
+ */
+static packed_word_t find_best_guess(hint_engine_t *engine) {
+  const yk_dict_t *dict = engine->dict;
+  histogram_set_t *set = &engine->histograms;
+  packed_word_t best;
+
+  if (set->num_candidates <= SOLVER_SAMPLE_SIZE)
+    best = histogram_set_best(set, NULL);
+  else
+    best = best_guess(dict->words, dict->num_words, set->candidates, set->num_candidates, NULL);
+
+  if (engine->num_guesses == 0) engine->first_guess = best;
+  return best;
+}
+
+/**
+   Gives the next hint. Each call after a guess gives a stronger hint
+   than the previous one: first the number of words that may still be
+   the answer, then a letter not yet revealed by the feedback that
+   every one of them contains, so that it must be in the answer, then
+   the best next guess. If there is no such letter, the best next
+   guess is given instead. Further calls repeat the best next guess.
+   The best guess is searched for when first given after a guess,
+   which may take a moment early in the game, unless the opening book
+   has it.
+
+   @param engine the hint state.
+
+   @param hint where the hint is stored.
+ */
+void hint_next(hint_engine_t *engine, hint_t *hint) {
+  memset(hint, 0, sizeof(*hint));
+  hint->num_candidates = engine->num_candidates;
+
+  switch (engine->level) {
+  case 0:
+    hint->type = HINT_NUM_CANDIDATES;
+    break;
+
+  case 1:
+    hint->type = HINT_LETTER;
+    for (int i = 0; i < NUM_LETTERS && engine->num_candidates > 0; i++) {
+      if (!(engine->known_letters & (1u << i)) && engine->letter_counts[i] == engine->num_candidates) {
+        hint->letter = 'a' + i;
+        hint->letter_count = engine->letter_counts[i];
+        break;
+      }
+    }
+    if (hint->letter != 0) break;
+    /* no unrevealed letter is shared by all candidates */
+    /* fall through */
+
+  default:
+    hint->type = HINT_BEST_GUESS;
+    if (engine->best_guess == 0) engine->best_guess = find_best_guess(engine);
+    if (engine->best_guess != 0) unpack_word(engine->best_guess, hint->guess);
+    break;
+  }
+
+  if (engine->level < HINT_BEST_GUESS) engine->level++;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "engine.h"
+#include "histo.h"
+#include "book.h"
+
+#define NUM_LETTERS 26
+
+typedef enum {
+  HINT_NUM_CANDIDATES = 0,
+  HINT_LETTER,
+  HINT_BEST_GUESS
+} hint_type_t;
+
+typedef struct hint {
+  hint_type_t type;
+
+  /** Number of words that may still be the answer. Always set. */
+  unsigned int num_candidates;
+
+  /** For HINT_LETTER, a letter not yet revealed by the feedback that
+      every candidate contains, so it must be in the answer, and the
+      number of candidates containing it, always `num_candidates`. */
+  char letter;
+  unsigned int letter_count;
+
+  /** For HINT_BEST_GUESS, the guess expected to give the most
+      information. */
+  char guess[WORD_SIZE + 1];
+} hint_t;
+
+typedef struct hint_engine {
+  const yk_dict_t *dict;
+
+  /** Number of words that may still be the answer, given the
+      feedback so far. The words themselves are the candidates of
+      `histograms`. */
+  unsigned int num_candidates;
+
+  /** Number of candidates containing each letter ('a' at index 0). */
+  unsigned int letter_counts[NUM_LETTERS];
+
+  /** Letters known to be in the answer from the feedback so far, one
+      bit per letter. */
+  uint32_t known_letters;
+
+  /** The candidates, filtered after each guess, and the feedback
+      histograms of every guess over them. The histograms are only
+      built when a best guess is asked for with few enough candidates,
+      and then kept up to date. */
+  histogram_set_t histograms;
+
+  /** Best guess for the current candidates, and the best first guess,
+      which is the same for every game, or zero until they are first
+      asked for. */
+  packed_word_t best_guess;
+  packed_word_t first_guess;
+
+  /** Opening book for the dictionary, or NULL, and the guesses made
+      so far and the feedback for the first one, to look it up. */
+  const opening_book_t *book;
+  unsigned int num_guesses;
+  packed_word_t first_played;
+  pattern_t first_pattern;
+
+  /** Number of hints given since the last guess. */
+  unsigned int level;
+} hint_engine_t;
+
+int hint_init(hint_engine_t *, const yk_dict_t *);
+int hint_init_book(hint_engine_t *, const yk_dict_t *, const opening_book_t *);
+void hint_free(hint_engine_t *);
+void hint_reset(hint_engine_t *);
+int hint_update(hint_engine_t *, const char[], const letter_result_t[]);
+void hint_next(hint_engine_t *, hint_t *);
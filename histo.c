@@ -0,0 +1,284 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "histo.h"
+#include "parallel.h"
+
+/* Number of guesses whose histograms are updated by each parallel
+   task. */
+#define GUESSES_PER_TASK 64
+
+/* Number of patterns computed at once, so that the buffer stays on the
+   stack and in cache. */
+#define CHUNK_SIZE 1024
+
+/* Updates with at most this many words score each word against the
+   guesses, rather than each guess against the words. */
+#define FEW_WORDS 256
+
+typedef struct histogram_job {
+  histogram_set_t *set;
+
+  /* Words to be added to (`sign` is 1) or removed from (`sign` is -1)
+     every histogram. If `reset` is set, the histograms are cleared
+     first. */
+  const packed_word_t *words;
+  unsigned int num_words;
+  int sign;
+  int reset;
+
+  /* Entropy of each guess, set by `score_histograms`, and the table
+     of `c * log2(c)` used to compute it. */
+  double *entropies;
+  const double *xlogx;
+} histogram_job_t;
+
+static void update_histograms(unsigned int task, void *data) {
+  histogram_job_t *job = data;
+  histogram_set_t *set = job->set;
+  unsigned int first = task * GUESSES_PER_TASK, end = first + GUESSES_PER_TASK;
+  pattern_t patterns[CHUNK_SIZE];
+
+  if (end > set->num_guesses) end = set->num_guesses;
+  if (job->reset) memset(set->counts + (size_t) first * NUM_PATTERNS, 0, (size_t) (end - first) * NUM_PATTERNS * sizeof(*set->counts));
+
+  /* With few words, scoring each word against all guesses of the task
+     at once keeps the vector kernel busy. */
+  if (job->num_words <= FEW_WORDS) {
+    for (unsigned int w = 0; w < job->num_words; w++) {
+      batch_score_guesses(set->guesses + first, end - first, job->words[w], patterns);
+      for (unsigned int g = first; g < end; g++) set->counts[(size_t) g * NUM_PATTERNS + patterns[g - first]] += job->sign;
+    }
+    return;
+  }
+
+  for (unsigned int g = first; g < end; g++) {
+    uint32_t *counts = set->counts + (size_t) g * NUM_PATTERNS;
+
+    for (unsigned int start = 0; start < job->num_words; start += CHUNK_SIZE) {
+      unsigned int size = job->num_words - start < CHUNK_SIZE ? job->num_words - start : CHUNK_SIZE;
+      batch_score_answers(set->guesses[g], job->words + start, size, patterns);
+      for (unsigned int i = 0; i < size; i++) counts[patterns[i]] += job->sign;
+    }
+  }
+}
+
+static void score_histograms(unsigned int task, void *data) {
+  histogram_job_t *job = data;
+  histogram_set_t *set = job->set;
+  unsigned int n = set->num_candidates;
+  unsigned int end = (task + 1) * GUESSES_PER_TASK;
+
+  if (end > set->num_guesses) end = set->num_guesses;
+  for (unsigned int g = task * GUESSES_PER_TASK; g < end; g++) {
+    const uint32_t *counts = set->counts + (size_t) g * NUM_PATTERNS;
+    double sum = 0;
+    for (int p = 0; p < NUM_PATTERNS; p++) sum += job->xlogx[counts[p]];
+    job->entropies[g] = n ? log2(n) - sum / n : 0;
+  }
+}
+
+static void run_job(histogram_job_t *job, parallel_task_t task) {
+  parallel_run((job->set->num_guesses + GUESSES_PER_TASK - 1) / GUESSES_PER_TASK, task, job);
+}
+
+/**
+   Computes the histograms from the current candidates, if they have
+   not been computed yet.
+
+   @returns a non-zero value if the histograms are available, or zero
+   if memory could not be allocated.
+ */
+static int build_histograms(histogram_set_t *set) {
+  histogram_job_t job = { .set = set, .words = set->candidates, .num_words = set->num_candidates,
+                          .sign = 1, .reset = 1 };
+
+  size_t size = (size_t) set->num_guesses * NUM_PATTERNS;
+
+  if (set->counts != NULL) return 1;
+
+  set->counts = malloc((size ? size : 1) * sizeof(*set->counts));
+  if (set->counts == NULL) return 0;
+
+  run_job(&job, update_histograms);
+  return 1;
+}
+
+/**
+   Prepares the feedback histograms of a set of guesses over a set of
+   candidates. The histograms are only computed when first needed, and
+   are then kept up to date by `histogram_set_update` as candidates are
+   removed, so later turns cost in proportion to what changed rather
+   than to the number of candidates.
+
+   @param set the struct to be initialized. Must be released with
+   `histogram_set_free` if this function succeeds.
+
+   @param guesses the words that may be guessed. Must not be released
+   while the set is in use.
+
+   @param num_guesses the number of items in `guesses`.
+
+   @param candidates the words that may be the answer. Copied into the
+   set.
+
+   @param num_candidates the number of items in `candidates`.
+
+   @returns a non-zero value if the set was initialized, or zero if
+   memory could not be allocated.
+ */
+int histogram_set_init(histogram_set_t *set, const packed_word_t guesses[], unsigned int num_guesses,
+                       const packed_word_t candidates[], unsigned int num_candidates) {
+  unsigned int size = num_candidates ? num_candidates : 1;
+
+  set->guesses = guesses;
+  set->num_guesses = num_guesses;
+  set->num_candidates = num_candidates;
+  set->counts = NULL;
+  set->candidates = malloc(size * sizeof(*set->candidates));
+  set->removed = malloc(size * sizeof(*set->removed));
+  set->patterns = malloc(size * sizeof(*set->patterns));
+  if (set->candidates == NULL || set->removed == NULL || set->patterns == NULL) {
+    histogram_set_free(set);
+    return 0;
+  }
+
+  memcpy(set->candidates, candidates, num_candidates * sizeof(*candidates));
+  return 1;
+}
+
+void histogram_set_free(histogram_set_t *set) {
+  free(set->candidates);
+  free(set->removed);
+  free(set->patterns);
+  free(set->counts);
+  set->candidates = NULL;
+  set->removed = NULL;
+  set->patterns = NULL;
+  set->counts = NULL;
+  set->num_candidates = 0;
+}
+
+/**
+   Replaces the candidates of a histogram set, as if it had just been
+   initialized with them. The histograms are computed again when next
+   needed.
+
+   @param candidates the words that may be the answer. Must not be more
+   than the candidates the set was initialized with.
+
+   @param num_candidates the number of items in `candidates`.
+ */
+void histogram_set_reset(histogram_set_t *set, const packed_word_t candidates[], unsigned int num_candidates) {
+  memcpy(set->candidates, candidates, num_candidates * sizeof(*candidates));
+  set->num_candidates = num_candidates;
+  free(set->counts);
+  set->counts = NULL;
+}
+
+/**
+   Removes the candidates that do not match the feedback for a guess,
+   and updates the histograms if they have been computed. The removed
+   candidates are subtracted from every histogram if they are fewer
+   than the remaining ones; otherwise, the histograms are computed
+   again from the remaining candidates.
+
+   @param set the histograms to be updated.
+
+   @param guess the packed guessed word.
+
+   @param pattern the feedback received for the guess.
+
+   @returns the number of remaining candidates.
+ */
+unsigned int histogram_set_update(histogram_set_t *set, packed_word_t guess, pattern_t pattern) {
+  unsigned int total = set->num_candidates, num_kept = 0, num_removed = 0;
+
+  batch_score_answers(guess, set->candidates, total, set->patterns);
+  for (unsigned int i = 0; i < total; i++) {
+    set->removed[num_removed] = set->candidates[i];
+    num_removed += set->patterns[i] != pattern;
+    set->candidates[num_kept] = set->candidates[i];
+    num_kept += set->patterns[i] == pattern;
+  }
+  set->num_candidates = num_kept;
+
+  if (set->counts != NULL && num_removed > 0) {
+    histogram_job_t job = { .set = set };
+    if (num_removed < num_kept) {
+      job.words = set->removed;
+      job.num_words = num_removed;
+      job.sign = -1;
+    } else {
+      job.words = set->candidates;
+      job.num_words = num_kept;
+      job.sign = 1;
+      job.reset = 1;
+    }
+    run_job(&job, update_histograms);
+  }
+
+  return num_kept;
+}
+
+/**
+   @returns the histogram of a guess over the current candidates: the
+   number of candidates giving each of the NUM_PATTERNS feedback
+   patterns. Valid until the next update. NULL if memory could not be
+   allocated.
+ */
+const uint32_t *histogram_set_get(histogram_set_t *set, unsigned int guess) {
+  if (!build_histograms(set)) return NULL;
+  return set->counts + (size_t) guess * NUM_PATTERNS;
+}
+
+/**
+   Finds the guess whose feedback has the highest entropy over the
+   current candidates, as `best_guess` does, but from the maintained
+   histograms and without sampling. Ties are broken the same way:
+   guesses that may be the answer first, then the one listed first.
+
+   @param set the histograms of the guesses.
+
+   @param entropy if not NULL, where the entropy of the best guess is
+   stored.
+
+   @returns the best guess, or zero if there are no guesses or memory
+   could not be allocated.
+ */
+packed_word_t histogram_set_best(histogram_set_t *set, double *entropy) {
+  unsigned int n = set->num_candidates;
+  histogram_job_t job = { .set = set };
+  packed_word_t best = 0;
+
+  if (entropy != NULL) *entropy = 0;
+  if (set->num_guesses == 0 || !build_histograms(set)) return 0;
+
+  double *xlogx = malloc((n + 1) * sizeof(*xlogx));
+  job.entropies = malloc(set->num_guesses * sizeof(*job.entropies));
+  if (xlogx == NULL || job.entropies == NULL) goto done;
+
+  for (unsigned int c = 0; c <= n; c++) xlogx[c] = c > 1 ? c * log2(c) : 0;
+  job.xlogx = xlogx;
+  run_job(&job, score_histograms);
+
+  unsigned int top = 0;
+  int top_is_candidate = set->counts[PATTERN_SOLVED] > 0;
+  for (unsigned int g = 1; g < set->num_guesses; g++) {
+    int is_candidate = set->counts[(size_t) g * NUM_PATTERNS + PATTERN_SOLVED] > 0;
+    if (job.entropies[g] > job.entropies[top]
+        || (job.entropies[g] == job.entropies[top] && is_candidate && !top_is_candidate)) {
+      top = g;
+      top_is_candidate = is_candidate;
+    }
+  }
+
+  best = set->guesses[top];
+  if (entropy != NULL) *entropy = job.entropies[top];
+
+ done:
+  free(xlogx);
+  free(job.entropies);
+  return best;
+}
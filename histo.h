@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "batch.h"
+
+typedef struct histogram_set {
+
+  /** Words that may be guessed. Not copied, so they must not be
+      released while the set is in use. */
+  const packed_word_t *guesses;
+  unsigned int num_guesses;
+
+  /** Words that may still be the answer, in their original order. */
+  packed_word_t *candidates;
+  unsigned int num_candidates;
+
+  /** Words that stopped being candidates in the last update, and the
+      feedback of the last guess for each candidate. */
+  packed_word_t *removed;
+  pattern_t *patterns;
+
+  /** For each guess, in order, the number of candidates giving each
+      feedback pattern: NUM_PATTERNS counts per guess. NULL until the
+      histograms are first needed. */
+  uint32_t *counts;
+} histogram_set_t;
+
+int histogram_set_init(histogram_set_t *, const packed_word_t[], unsigned int, const packed_word_t[], unsigned int);
+void histogram_set_free(histogram_set_t *);
+void histogram_set_reset(histogram_set_t *, const packed_word_t[], unsigned int);
+unsigned int histogram_set_update(histogram_set_t *, packed_word_t, pattern_t);
+const uint32_t *histogram_set_get(histogram_set_t *, unsigned int);
+packed_word_t histogram_set_best(histogram_set_t *, double *);
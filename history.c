@@ -0,0 +1,216 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "history.h"
+
+/* First line of a history written by `history_write`. */
+#define HISTORY_HEADER "yorkle-history 1"
+
+/**
+   Prepares an empty history.
+
+   @param history the struct to be initialized. Must be released with
+   `history_free` if this function succeeds.
+
+   @returns a non-zero value if the history was initialized, or zero if
+   memory could not be allocated.
+ */
+int history_init(history_t *history) {
+  history->current_streak = 0;
+  history->max_streak = 0;
+  for (int i = 0; i < HISTORY_WINDOW_DAYS; i++) {
+    history->days[i].day = -1;
+    history->days[i].num_games = 0;
+    history->days[i].num_wins = 0;
+  }
+
+  history->num_answers = 0;
+  history->capacity = 256;
+  history->answers = calloc(history->capacity, sizeof(*history->answers));
+  return history->answers != NULL;
+}
+
+void history_free(history_t *history) {
+  free(history->answers);
+  history->answers = NULL;
+  history->num_answers = 0;
+  history->capacity = 0;
+}
+
+static answer_history_t *find_slot(answer_history_t answers[], unsigned int capacity, packed_word_t answer) {
+  unsigned int slot = (answer * 0x9e3779b1u) >> 8 & (capacity - 1);
+  while (answers[slot].answer != 0 && answers[slot].answer != answer)
+    slot = (slot + 1) & (capacity - 1);
+  return &answers[slot];
+}
+
+/**
+   Finds the entry of an answer, adding an empty one (with `answer`
+   set) if there is none.
+
+   @returns the entry, or NULL if memory could not be allocated.
+ */
+static answer_history_t *find_entry(history_t *history, packed_word_t answer) {
+  if (2 * (history->num_answers + 1) > history->capacity) {
+    unsigned int capacity = history->capacity * 2;
+    answer_history_t *answers = calloc(capacity, sizeof(*answers));
+    if (answers == NULL) return NULL;
+    for (unsigned int i = 0; i < history->capacity; i++)
+      if (history->answers[i].answer != 0)
+        *find_slot(answers, capacity, history->answers[i].answer) = history->answers[i];
+    free(history->answers);
+    history->answers = answers;
+    history->capacity = capacity;
+  }
+
+  answer_history_t *entry = find_slot(history->answers, history->capacity, answer);
+  if (entry->answer == 0) {
+    entry->answer = answer;
+    history->num_answers++;
+  }
+  return entry;
+}
+
+/**
+   Adds the result of a game to a history. Takes constant time (apart
+   from the occasional growth of the answer table), whatever the number
+   of games in the history.
+
+   @param history the history to be updated.
+
+   @param day the day the game was played on. Games must be added in
+   the order they were played.
+
+   @param answer the packed answer of the game.
+
+   @param outcome the outcome of the game, as expected by `save_stats`.
+
+   @returns a non-zero value if the game was added, or zero if memory
+   could not be allocated or the arguments are invalid.
+ */
+int history_add(history_t *history, int32_t day, packed_word_t answer, unsigned int outcome) {
+  int won = outcome >= 1 && outcome <= MAX_NUM_ATTEMPTS;
+
+  if (answer == 0 || day < 0 || outcome == 0 || outcome > MAX_NUM_ATTEMPTS + 1) return 0;
+
+  answer_history_t *entry = find_entry(history, answer);
+  if (entry == NULL) return 0;
+
+  entry->num_games++;
+  entry->num_wins += won;
+  entry->last_outcome = outcome;
+  entry->last_day = day;
+
+  history_day_t *slot = &history->days[day % HISTORY_WINDOW_DAYS];
+  if (slot->day != day) {
+    slot->day = day;
+    slot->num_games = 0;
+    slot->num_wins = 0;
+  }
+  slot->num_games++;
+  slot->num_wins += won;
+
+  history->current_streak = won ? history->current_streak + 1 : 0;
+  if (history->current_streak > history->max_streak) history->max_streak = history->current_streak;
+  return 1;
+}
+
+/**
+   Counts the games played in the HISTORY_WINDOW_DAYS days up to a
+   given day, included.
+
+   @param num_wins where the number of those games that were won is
+   stored.
+
+   @returns the number of games.
+ */
+unsigned int history_recent(const history_t *history, int32_t today, unsigned int *num_wins) {
+  unsigned int num_games = 0;
+
+  *num_wins = 0;
+  for (int i = 0; i < HISTORY_WINDOW_DAYS; i++) {
+    const history_day_t *slot = &history->days[i];
+    if (slot->day < 0 || slot->day > today || slot->day <= today - HISTORY_WINDOW_DAYS) continue;
+    num_games += slot->num_games;
+    *num_wins += slot->num_wins;
+  }
+  return num_games;
+}
+
+/**
+   @returns the games played with an answer, or NULL if none were.
+ */
+const answer_history_t *history_answer(const history_t *history, packed_word_t answer) {
+  if (answer == 0) return NULL;
+  const answer_history_t *entry = find_slot(history->answers, history->capacity, answer);
+  return entry->answer != 0 ? entry : NULL;
+}
+
+/**
+   Writes a summary of a history, from which `history_read` restores
+   it, as text: a header line, a line with the streaks, a line for each
+   day in the window, and a line for each answer.
+
+   @returns a non-zero value on success, or zero if the summary could
+   not be written.
+ */
+int history_write(FILE *fh, const history_t *history) {
+  char word[WORD_SIZE + 1];
+
+  fprintf(fh, "%s\nstreak %u %u\n", HISTORY_HEADER, history->current_streak, history->max_streak);
+  for (int i = 0; i < HISTORY_WINDOW_DAYS; i++) {
+    const history_day_t *slot = &history->days[i];
+    if (slot->day >= 0) fprintf(fh, "day %d %u %u\n", slot->day, slot->num_games, slot->num_wins);
+  }
+  for (unsigned int i = 0; i < history->capacity; i++) {
+    const answer_history_t *entry = &history->answers[i];
+    if (entry->answer == 0) continue;
+    unpack_word(entry->answer, word);
+    fprintf(fh, "answer %s %u %u %u %d\n", word, entry->num_games, entry->num_wins,
+            entry->last_outcome, entry->last_day);
+  }
+  return !ferror(fh);
+}
+
+/**
+   Restores a history from a summary written by `history_write`.
+
+   @param history the struct to be initialized. Must be released with
+   `history_free` if this function succeeds.
+
+   @returns a non-zero value if the history was read, or zero if memory
+   could not be allocated or the summary is not valid.
+ */
+int history_read(FILE *fh, history_t *history) {
+  char line[128], word[WORD_SIZE + 2];
+  history_day_t day;
+  answer_history_t entry;
+
+  if (!history_init(history)) return 0;
+  if (fgets(line, sizeof(line), fh) == NULL || strcmp(line, HISTORY_HEADER "\n") != 0
+      || fscanf(fh, " streak %u %u", &history->current_streak, &history->max_streak) != 2)
+    goto invalid;
+
+  while (fscanf(fh, " day %d %u %u", &day.day, &day.num_games, &day.num_wins) == 3) {
+    if (day.day < 0) goto invalid;
+    history->days[day.day % HISTORY_WINDOW_DAYS] = day;
+  }
+
+  while (fscanf(fh, " answer %6s %u %u %u %d", word, &entry.num_games, &entry.num_wins,
+                &entry.last_outcome, &entry.last_day) == 5) {
+    entry.answer = pack_word(word);
+    if (entry.answer == 0 || strlen(word) != WORD_SIZE || entry.num_games == 0) goto invalid;
+
+    if (history_answer(history, entry.answer) != NULL) goto invalid;
+    answer_history_t *slot = find_entry(history, entry.answer);
+    if (slot == NULL) goto invalid;
+    *slot = entry;
+  }
+
+  if (!feof(fh) || ferror(fh)) goto invalid;
+  return 1;
+
+ invalid:
+  history_free(history);
+  return 0;
+}
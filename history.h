@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "batch.h"
+
+/* Number of days covered by the rolling win rate. */
+#define HISTORY_WINDOW_DAYS 30
+
+typedef struct history_day {
+
+  /** Day number (days since 1970-01-01, local time), or -1 if the slot
+      has not been used. */
+  int32_t day;
+
+  unsigned int num_games;
+  unsigned int num_wins;
+} history_day_t;
+
+typedef struct answer_history {
+
+  /** The answer, or zero for an empty slot. */
+  packed_word_t answer;
+
+  unsigned int num_games;
+  unsigned int num_wins;
+
+  /** Outcome of the last game with this answer, as expected by
+      `save_stats`, and the day it was played. */
+  unsigned int last_outcome;
+  int32_t last_day;
+} answer_history_t;
+
+typedef struct history {
+
+  /** Number of games won in a row up to the last game, and the longest
+      such run. */
+  unsigned int current_streak;
+  unsigned int max_streak;
+
+  /** Games and wins per day for the last HISTORY_WINDOW_DAYS days
+      played, in slot `day % HISTORY_WINDOW_DAYS`. */
+  history_day_t days[HISTORY_WINDOW_DAYS];
+
+  /** Open-addressing table of the games played with each answer,
+      indexed by a hash of the answer. */
+  answer_history_t *answers;
+  unsigned int num_answers;
+  unsigned int capacity;
+} history_t;
+
+int history_init(history_t *);
+void history_free(history_t *);
+int history_add(history_t *, int32_t, packed_word_t, unsigned int);
+unsigned int history_recent(const history_t *, int32_t, unsigned int *);
+const answer_history_t *history_answer(const history_t *, packed_word_t);
+
+int history_write(FILE *, const history_t *);
+int history_read(FILE *, history_t *);
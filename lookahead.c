@@ -0,0 +1,382 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+
+#include "lookahead.h"
+#include "solver.h"
+#include "parallel.h"
+
+/* Depth-2 search: a first guess is worth the number of candidates
+   left after it and the best follow-up for its feedback, on
+   average. Finding the best follow-up for every feedback of every
+   first guess is too slow, so only the first guesses that leave the
+   fewest candidates on their own are considered, and each is given up
+   on as soon as a bound on what its follow-ups could achieve shows it
+   cannot beat the best so far.
+
+   Costs are kept as sums of squared bucket sizes: a bucket of `s`
+   candidates, reached with probability `s / n`, leaves `s`
+   candidates, so the expected number left is the sum of `s * s`
+   divided by `n`. Buckets where the answer was found leave none. */
+
+/* Number of first guesses ranked by each parallel task. */
+#define GUESSES_PER_TASK 128
+
+/* Number of follow-ups `bucket_cost` tries between checks of the
+   deadline. */
+#define GUESSES_PER_CHECK 1024
+
+/**
+   @returns a lower bound of the cost of a bucket of `size` candidates
+   after the best follow-up. At best, the follow-up is one of the
+   candidates, so one of them is found, and the others are split over
+   the NUM_PATTERNS-1 other patterns as evenly as possible. Costs are
+   integers, so the bound is rounded up.
+ */
+static uint64_t bucket_bound(unsigned int size) {
+  uint64_t rest = size > 0 ? size - 1 : 0;
+  uint64_t even = (rest * rest + NUM_PATTERNS - 2) / (NUM_PATTERNS - 1);
+  return even > rest ? even : rest;
+}
+
+/* Adds up the squares of the counts of a histogram, except for the
+   bucket where the answer was found. */
+static uint64_t histogram_cost(const unsigned int histogram[]) {
+  uint64_t cost = 0;
+  for (int p = 0; p < NUM_PATTERNS; p++)
+    if (p != PATTERN_SOLVED) cost += (uint64_t) histogram[p] * histogram[p];
+  return cost;
+}
+
+typedef struct lookahead {
+  const packed_word_t *guesses;
+  unsigned int num_guesses;
+  const packed_word_t *candidates;
+  unsigned int num_candidates;
+
+  /* The pattern of every guess against every candidate, one row per
+     guess. Every group of candidates of every first guess is a subset
+     of the candidates, so follow-ups are evaluated from this table
+     without scoring anything again. */
+  pattern_t *patterns;
+
+  /* Cost of each guess without a follow-up, a bound of its cost with
+     the best follow-ups, and whether it may be the answer. */
+  uint64_t *scores;
+  uint64_t *bounds;
+  unsigned char *is_candidate;
+
+  /* Positions in `guesses` of the guesses to evaluate, best score
+     first, and the exact cost of each, or UINT64_MAX if it was
+     pruned. */
+  unsigned int *shortlist;
+  unsigned int shortlist_size;
+  uint64_t *costs;
+
+  /* Lowest exact cost found so far, shared by all tasks. */
+  uint64_t best_cost;
+
+  /* Time by which the search must end, or NULL, and whether it has
+     passed. */
+  const struct timespec *deadline;
+  int timed_out;
+
+  /* Set if memory could not be allocated. */
+  int failed;
+} lookahead_t;
+
+/**
+   @returns whether the deadline of the search has passed. Once it
+   has, every task stops at its next check.
+ */
+static int past_deadline(lookahead_t *lookahead) {
+  struct timespec now;
+
+  if (lookahead->deadline == NULL) return 0;
+  if (__atomic_load_n(&lookahead->timed_out, __ATOMIC_RELAXED)) return 1;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (now.tv_sec < lookahead->deadline->tv_sec
+      || (now.tv_sec == lookahead->deadline->tv_sec && now.tv_nsec < lookahead->deadline->tv_nsec))
+    return 0;
+  __atomic_store_n(&lookahead->timed_out, 1, __ATOMIC_RELAXED);
+  return 1;
+}
+
+/**
+   Finds the cost of a bucket after its best follow-up.
+
+   @param bucket the positions in `lookahead->candidates` of the
+   candidates in the bucket.
+
+   @param size the number of items in `bucket`.
+
+   @returns the lowest cost of any guess, or UINT64_MAX if memory
+   could not be allocated or the deadline passed.
+ */
+static uint64_t bucket_cost(lookahead_t *lookahead, const unsigned int bucket[], unsigned int size) {
+  unsigned int histogram[NUM_PATTERNS];
+  uint64_t best = UINT64_MAX;
+
+  if (size <= 2) return size > 0 ? size - 1 : 0;
+
+  /* Guessing one of the candidates is often best, and reaching the
+     bound proves it. */
+  packed_word_t *words = malloc(size * sizeof(*words));
+  if (words == NULL) return UINT64_MAX;
+  for (unsigned int c = 0; c < size; c++) words[c] = lookahead->candidates[bucket[c]];
+  for (unsigned int c = 0; c < size && best > bucket_bound(size); c++) {
+    pattern_histogram(words[c], words, size, histogram);
+    uint64_t cost = histogram_cost(histogram);
+    if (cost < best) best = cost;
+  }
+  free(words);
+  if (best <= bucket_bound(size)) return best;
+
+  /* Each guess is given up on as soon as it is no better than the best
+     so far; squares are added up one candidate at a time, as
+     `(k + 1)^2 - k^2 = 2k + 1`. */
+  unsigned int counts[NUM_PATTERNS] = { 0 };
+  for (unsigned int g = 0; g < lookahead->num_guesses; g++) {
+    if (g % GUESSES_PER_CHECK == GUESSES_PER_CHECK - 1 && past_deadline(lookahead)) return UINT64_MAX;
+
+    const pattern_t *row = lookahead->patterns + (size_t) g * lookahead->num_candidates;
+    uint64_t cost = 0;
+    unsigned int c = 0;
+
+    while (c < size && cost < best) {
+      pattern_t pattern = row[bucket[c++]];
+      if (pattern != PATTERN_SOLVED) cost += 2 * counts[pattern]++ + 1;
+    }
+    while (c > 0) counts[row[bucket[--c]]] = 0;
+    if (cost < best) best = cost;
+  }
+  return best;
+}
+
+static void rank_guesses(unsigned int task, void *data) {
+  lookahead_t *lookahead = data;
+  unsigned int histogram[NUM_PATTERNS];
+  unsigned int end = (task + 1) * GUESSES_PER_TASK;
+
+  if (end > lookahead->num_guesses) end = lookahead->num_guesses;
+  if (past_deadline(lookahead)) return;
+  for (unsigned int g = task * GUESSES_PER_TASK; g < end; g++) {
+    pattern_t *row = lookahead->patterns + (size_t) g * lookahead->num_candidates;
+
+    batch_score_answers(lookahead->guesses[g], lookahead->candidates, lookahead->num_candidates, row);
+    memset(histogram, 0, sizeof(histogram));
+    for (unsigned int c = 0; c < lookahead->num_candidates; c++) histogram[row[c]]++;
+
+    uint64_t bound = 0;
+    for (int p = 0; p < NUM_PATTERNS; p++)
+      if (p != PATTERN_SOLVED) bound += bucket_bound(histogram[p]);
+    lookahead->scores[g] = histogram_cost(histogram);
+    lookahead->bounds[g] = bound;
+    lookahead->is_candidate[g] = histogram[PATTERN_SOLVED] > 0;
+  }
+}
+
+/**
+   Computes the exact cost of one shortlisted guess, giving up as soon
+   as it cannot beat the best cost found so far. Guesses that tie with
+   the best are never given up on, so the result does not depend on
+   the order in which tasks run.
+ */
+static void evaluate_guess(unsigned int task, void *data) {
+  lookahead_t *lookahead = data;
+  unsigned int num_candidates = lookahead->num_candidates;
+  unsigned int counts[NUM_PATTERNS] = { 0 }, starts[NUM_PATTERNS + 1];
+
+  lookahead->costs[task] = UINT64_MAX;
+  if (lookahead->bounds[lookahead->shortlist[task]] > __atomic_load_n(&lookahead->best_cost, __ATOMIC_RELAXED)
+      || past_deadline(lookahead))
+    return;
+
+  const pattern_t *patterns = lookahead->patterns + (size_t) lookahead->shortlist[task] * num_candidates;
+  unsigned int *sorted = malloc(num_candidates * sizeof(*sorted));
+  if (sorted == NULL) {
+    __atomic_store_n(&lookahead->failed, 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  for (unsigned int i = 0; i < num_candidates; i++) counts[patterns[i]]++;
+  starts[0] = 0;
+  for (int p = 0; p < NUM_PATTERNS; p++) starts[p + 1] = starts[p] + counts[p];
+  unsigned int next[NUM_PATTERNS];
+  memcpy(next, starts, sizeof(next));
+  for (unsigned int i = 0; i < num_candidates; i++) sorted[next[patterns[i]]++] = i;
+
+  /* The bound of the buckets not evaluated yet, plus the exact cost of
+     the others, is a bound of the whole guess that tightens as buckets
+     are evaluated. Large buckets are the most expensive, but also
+     where the bound is most likely to be exceeded early. */
+  uint64_t bound = lookahead->bounds[lookahead->shortlist[task]];
+  uint64_t cost = 0;
+  for (;;) {
+    int largest = -1;
+    for (int p = 0; p < NUM_PATTERNS; p++)
+      if (p != PATTERN_SOLVED && counts[p] > 0 && (largest < 0 || counts[p] > counts[largest])) largest = p;
+    if (largest < 0) break;
+
+    uint64_t bucket = bucket_cost(lookahead, sorted + starts[largest], counts[largest]);
+    if (bucket == UINT64_MAX) {
+      if (!past_deadline(lookahead)) __atomic_store_n(&lookahead->failed, 1, __ATOMIC_RELAXED);
+      goto done;
+    }
+    cost += bucket;
+    bound += bucket - bucket_bound(counts[largest]);
+    counts[largest] = 0;
+    if (bound > __atomic_load_n(&lookahead->best_cost, __ATOMIC_RELAXED)) goto done;
+  }
+
+  lookahead->costs[task] = cost;
+  uint64_t best = __atomic_load_n(&lookahead->best_cost, __ATOMIC_RELAXED);
+  while (cost < best && !__atomic_compare_exchange_n(&lookahead->best_cost, &best, cost, 1,
+                                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+ done:
+  free(sorted);
+}
+
+/* Context for `compare_scores`, which qsort cannot pass. */
+static __thread const lookahead_t *sorting;
+
+/* Orders guesses by score, then candidates first, then by position. */
+static int compare_scores(const void *a, const void *b) {
+  unsigned int x = *(const unsigned int *) a, y = *(const unsigned int *) b;
+  if (sorting->scores[x] != sorting->scores[y]) return sorting->scores[x] < sorting->scores[y] ? -1 : 1;
+  if (sorting->is_candidate[x] != sorting->is_candidate[y]) return sorting->is_candidate[x] ? -1 : 1;
+  return x < y ? -1 : x > y;
+}
+
+/* Breaks ties between guesses with the same cost, as in
+   `best_guess`. */
+static int better_tie(const lookahead_t *lookahead, unsigned int a, unsigned int b) {
+  if (lookahead->is_candidate[a] != lookahead->is_candidate[b]) return lookahead->is_candidate[a];
+  return a < b;
+}
+
+/**
+   Finds the guess that leaves the fewest candidates, on average, after
+   it and the best follow-up for each feedback it may give. Unlike
+   `best_guess`, which only looks one guess ahead, this avoids guesses
+   that split the candidates well but leave groups that no second
+   guess can split.
+
+   Only the LOOKAHEAD_SHORTLIST_SIZE guesses that leave the fewest
+   candidates on their own are considered, so the result is a
+   heuristic, not the true depth-2 optimum: a guess that splits the
+   candidates less well on its own, but better with its follow-ups,
+   is missed. The bound below rarely rules a guess out before its
+   groups are evaluated, so considering every guess takes about a
+   hundred times as long. The shortlist is evaluated in
+   parallel, best first. Each is also given an optimistic bound, from
+   the sizes of the groups it splits the candidates into, and is
+   abandoned as soon as its bound, refined as its groups are
+   evaluated, is worse than the best guess found so far. Ties are
+   broken as in `best_guess`: guesses that may be the answer first,
+   then the one listed first.
+
+   @param guesses the words that may be guessed.
+
+   @param num_guesses the number of items in `guesses`.
+
+   @param candidates the words that may still be the answer.
+
+   @param num_candidates the number of items in `candidates`. Must not
+   be more than LOOKAHEAD_MAX_CANDIDATES, as the feedback of every
+   guess for every candidate is kept in memory.
+
+   @param expected if not NULL, where the expected number of
+   candidates left after the best guess and its follow-up is stored,
+   not counting an answer that was found.
+
+   @returns the best guess, or zero if there are no guesses or
+   candidates, there are more than LOOKAHEAD_MAX_CANDIDATES candidates
+   (errno is set to EINVAL), or memory could not be allocated.
+ */
+packed_word_t lookahead_guess(const packed_word_t guesses[], unsigned int num_guesses,
+                              const packed_word_t candidates[], unsigned int num_candidates, double *expected) {
+  return lookahead_guess_until(guesses, num_guesses, candidates, num_candidates, NULL, expected);
+}
+
+/**
+   Same as `lookahead_guess`, but gives up if the search is not
+   finished by a deadline. All tasks check the clock regularly, so the
+   search ends shortly after it.
+
+   @param deadline the time, on the CLOCK_MONOTONIC clock, by which the
+   search must end, or NULL to search until it is finished.
+
+   @returns the best guess, or zero if there are no guesses or
+   candidates, memory could not be allocated, or the deadline passed
+   (errno is set to ETIMEDOUT).
+ */
+packed_word_t lookahead_guess_until(const packed_word_t guesses[], unsigned int num_guesses,
+                                    const packed_word_t candidates[], unsigned int num_candidates,
+                                    const struct timespec *deadline, double *expected) {
+  lookahead_t lookahead = { .guesses = guesses, .num_guesses = num_guesses, .candidates = candidates,
+                            .num_candidates = num_candidates, .best_cost = UINT64_MAX, .deadline = deadline };
+  packed_word_t best = 0;
+
+  if (expected != NULL) *expected = 0;
+  if (num_guesses == 0) return 0;
+  if (num_candidates <= 2) return num_candidates > 0 ? candidates[0] : 0;
+  if (num_candidates > LOOKAHEAD_MAX_CANDIDATES) {
+    errno = EINVAL;
+    return 0;
+  }
+
+  lookahead.scores = malloc(num_guesses * sizeof(*lookahead.scores));
+  lookahead.bounds = malloc(num_guesses * sizeof(*lookahead.bounds));
+  lookahead.is_candidate = malloc(num_guesses * sizeof(*lookahead.is_candidate));
+  lookahead.shortlist = malloc(num_guesses * sizeof(*lookahead.shortlist));
+  lookahead.costs = malloc(LOOKAHEAD_SHORTLIST_SIZE * sizeof(*lookahead.costs));
+  lookahead.patterns = malloc((size_t) num_guesses * num_candidates);
+  if (lookahead.scores == NULL || lookahead.bounds == NULL || lookahead.is_candidate == NULL
+      || lookahead.shortlist == NULL || lookahead.costs == NULL || lookahead.patterns == NULL)
+    goto done;
+
+  parallel_run((num_guesses + GUESSES_PER_TASK - 1) / GUESSES_PER_TASK, rank_guesses, &lookahead);
+  if (past_deadline(&lookahead)) {
+    errno = ETIMEDOUT;
+    goto done;
+  }
+
+  for (unsigned int g = 0; g < num_guesses; g++) lookahead.shortlist[g] = g;
+  sorting = &lookahead;
+  qsort(lookahead.shortlist, num_guesses, sizeof(*lookahead.shortlist), compare_scores);
+  lookahead.shortlist_size = num_guesses < LOOKAHEAD_SHORTLIST_SIZE ? num_guesses : LOOKAHEAD_SHORTLIST_SIZE;
+
+  parallel_run(lookahead.shortlist_size, evaluate_guess, &lookahead);
+  if (lookahead.failed) goto done;
+  if (lookahead.timed_out) {
+    errno = ETIMEDOUT;
+    goto done;
+  }
+
+  int top = -1;
+  for (unsigned int i = 0; i < lookahead.shortlist_size; i++) {
+    if (lookahead.costs[i] == UINT64_MAX) continue;
+    if (top < 0 || lookahead.costs[i] < lookahead.costs[top]
+        || (lookahead.costs[i] == lookahead.costs[top] && better_tie(&lookahead, lookahead.shortlist[i], lookahead.shortlist[top])))
+      top = i;
+  }
+
+  if (top >= 0) {
+    best = guesses[lookahead.shortlist[top]];
+    if (expected != NULL) *expected = (double) lookahead.costs[top] / num_candidates;
+  }
+
+ done:
+  free(lookahead.scores);
+  free(lookahead.bounds);
+  free(lookahead.is_candidate);
+  free(lookahead.shortlist);
+  free(lookahead.costs);
+  free(lookahead.patterns);
+  return best;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <time.h>
+
+#include "batch.h"
+
+/* Number of first guesses, those leaving the fewest candidates on
+   their own, that `lookahead_guess` evaluates with every follow-up.
+   Guesses outside the shortlist are never considered, so the result
+   is a heuristic rather than the true depth-2 optimum. */
+#define LOOKAHEAD_SHORTLIST_SIZE 64
+
+/* Most candidates `lookahead_guess` accepts. With more, it would be
+   too slow for interactive use and need num_guesses times as many
+   bytes of memory; callers should fall back to `best_guess`. */
+#define LOOKAHEAD_MAX_CANDIDATES 1024
+
+packed_word_t lookahead_guess(const packed_word_t[], unsigned int, const packed_word_t[], unsigned int, double *);
+packed_word_t lookahead_guess_until(const packed_word_t[], unsigned int, const packed_word_t[], unsigned int,
+                                    const struct timespec *, double *);
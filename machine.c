@@ -0,0 +1,111 @@
+#include <string.h>
+
+#include "machine.h"
+
+/* The game as an explicit state machine. `yk_step` never blocks and
+   never performs I/O: the caller reads input however it wants and
+   feeds it in, and reacts to the events that come out. This allows a
+   single thread to drive any number of games, e.g., from an event
+   loop. */
+
+/**
+   Prepares a game to be driven by `yk_step`. The machine starts in
+   YK_STATE_INIT.
+
+   @param machine the struct where the game state is to be stored.
+
+   @param dict the dictionary of valid guesses. Must not be released
+   while the game is in use.
+
+   @param answer the correct answer for the game.
+
+   @returns a non-zero value if the game was started, or zero if the
+   answer is not a valid word, as in `yk_game_init`.
+ */
+int yk_machine_init(yk_machine_t *machine, const yk_dict_t *dict, const char answer[]) {
+  machine->state = YK_STATE_INIT;
+  return yk_game_init(&machine->game, dict, answer);
+}
+
+/**
+   Prepares a game to be driven by `yk_step`, scored with a daily table
+   as in `yk_game_init_daily`. The machine starts in YK_STATE_INIT.
+
+   @returns a non-zero value.
+ */
+int yk_machine_init_daily(yk_machine_t *machine, const yk_daily_t *daily) {
+  machine->state = YK_STATE_INIT;
+  return yk_game_init_daily(&machine->game, daily);
+}
+
+static yk_event_t *add_event(yk_event_t events[], unsigned int *num_events, yk_event_type_t type) {
+  yk_event_t *event = &events[(*num_events)++];
+  memset(event, 0, sizeof(*event));
+  event->type = type;
+  return event;
+}
+
+/**
+   Advances the game by one step:
+
+   - In YK_STATE_INIT, the input is ignored, the machine moves to
+     YK_STATE_AWAITING_GUESS and emits YK_EVENT_AWAIT_GUESS.
+
+   - In YK_STATE_AWAITING_GUESS, the input is submitted as a
+     guess. Emits YK_EVENT_INVALID_GUESS if it is not a valid word, or
+     YK_EVENT_FEEDBACK otherwise. If the game is over, the machine
+     moves to YK_STATE_FINISHED and emits YK_EVENT_FINISHED; otherwise
+     emits YK_EVENT_AWAIT_GUESS for the next attempt.
+
+   - In YK_STATE_FINISHED, nothing happens.
+
+   @param machine the game state, updated by the step.
+
+   @param input the word guessed by the player. May be NULL when no
+   guess is being submitted, in which case YK_STATE_AWAITING_GUESS is
+   left unchanged.
+
+   @param events an array where the events produced by this step are
+   stored, in order. Must have space for YK_MAX_EVENTS elements.
+
+   @returns the number of events stored in `events`.
+ */
+unsigned int yk_step(yk_machine_t *machine, const char input[], yk_event_t events[]) {
+  unsigned int num_events = 0;
+  yk_game_t *game = &machine->game;
+  yk_event_t *event;
+
+  switch (machine->state) {
+  case YK_STATE_INIT:
+    machine->state = YK_STATE_AWAITING_GUESS;
+    event = add_event(events, &num_events, YK_EVENT_AWAIT_GUESS);
+    event->attempt = game->num_attempts + 1;
+    break;
+
+  case YK_STATE_AWAITING_GUESS:
+    if (input == NULL) break;
+
+    event = add_event(events, &num_events, YK_EVENT_FEEDBACK);
+    strncpy(event->guess, input, WORD_SIZE);
+    event->attempt = game->num_attempts + 1;
+
+    if (yk_game_submit(game, input, event->result) == YK_GUESS_INVALID) {
+      event->type = YK_EVENT_INVALID_GUESS;
+    } else if (yk_game_finished(game)) {
+      machine->state = YK_STATE_FINISHED;
+      event = add_event(events, &num_events, YK_EVENT_FINISHED);
+      event->attempt = game->num_attempts;
+      event->outcome = yk_game_result(game);
+      break;
+    }
+
+    event = add_event(events, &num_events, YK_EVENT_AWAIT_GUESS);
+    event->attempt = game->num_attempts + 1;
+    break;
+
+  case YK_STATE_FINISHED:
+    break;
+  }
+
+  return num_events;
+}
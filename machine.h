@@ -0,0 +1,51 @@
+#pragma once
+
+#include "engine.h"
+
+/* Maximum number of events produced by a single call to `yk_step`. */
+#define YK_MAX_EVENTS 3
+
+typedef enum {
+  YK_STATE_INIT = 0,
+  YK_STATE_AWAITING_GUESS,
+  YK_STATE_FINISHED
+} yk_state_t;
+
+typedef enum {
+
+  /** A guess is expected. `attempt` holds the attempt number. */
+  YK_EVENT_AWAIT_GUESS = 0,
+
+  /** The input was not a valid word. `guess` holds the input. */
+  YK_EVENT_INVALID_GUESS,
+
+  /** A valid guess was scored. `guess`, `attempt` and `result` are
+      set. */
+  YK_EVENT_FEEDBACK,
+
+  /** The game is over. `outcome` holds the number of attempts needed
+      to find the answer, or MAX_NUM_ATTEMPTS+1 if it was not found,
+      as expected by `save_stats`. */
+  YK_EVENT_FINISHED
+} yk_event_type_t;
+
+typedef struct yk_event {
+  yk_event_type_t type;
+  unsigned int attempt;
+  char guess[WORD_SIZE + 1];
+  letter_result_t result[WORD_SIZE];
+  unsigned int outcome;
+} yk_event_t;
+
+typedef struct yk_machine {
+
+  /** Current state. Only changed by `yk_step`. */
+  yk_state_t state;
+
+  /** The game being played. */
+  yk_game_t game;
+} yk_machine_t;
+
+int yk_machine_init(yk_machine_t *, const yk_dict_t *, const char[]);
+int yk_machine_init_daily(yk_machine_t *, const yk_daily_t *);
+unsigned int yk_step(yk_machine_t *, const char[], yk_event_t[]);
@@ -1,49 +1,558 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "yorkle.h"
+#include "machine.h"
+#include "zygote.h"
+#include "counters.h"
 
-int main(void) {
+/* Most strategies that can play in one tournament. */
+#define MAX_STRATEGIES 16
 
-  valid_word_list_t valid_words;
+/**
+   Plays one game in the terminal, driving the engine state machine
+   with attempts read from standard input. Entering HINT_COMMAND as an
+   attempt shows a hint instead.
+
+   @param machine the game to be played, in its initial state.
+
+   @param hints the hint state for the game, in its initial state.
+
+   @param json non-zero to print each guess as a line of JSON, without
+   prompts, colours or hints, for automated clients.
+
+   @param outcome where the result of the game is stored, as expected
+   by `save_stats`.
+
+   @returns a non-zero value if the game finished, or zero if the
+   input ended before that.
+ */
+static int play_game(yk_machine_t *machine, hint_engine_t *hints, int json, unsigned int *outcome) {
+  yk_event_t events[YK_MAX_EVENTS];
+  char current_attempt[WORD_SIZE + 2];
+  const char *input = NULL;
+
+  while (machine->state != YK_STATE_FINISHED) {
+    unsigned int num_events = yk_step(machine, input, events);
+    input = NULL;
+
+    for (unsigned int i = 0; i < num_events; i++) {
+      yk_event_t *event = &events[i];
+
+      switch (event->type) {
+      case YK_EVENT_AWAIT_GUESS:
+        if (json) {
+          if (!read_word(current_attempt))
+            return 0;
+          input = current_attempt;
+          break;
+        }
+        for (;;) {
+          if (!read_attempt(event->attempt, current_attempt))
+            return 0;
+          if (strcmp(current_attempt, HINT_COMMAND) != 0) break;
+
+          hint_t hint;
+          hint_next(hints, &hint);
+          print_hint(&hint);
+        }
+        input = current_attempt;
+        break;
+      case YK_EVENT_INVALID_GUESS:
+        if (json)
+          print_json_guess(event->guess, NULL, MAX_NUM_ATTEMPTS - machine->game.num_attempts,
+                           hints->num_candidates);
+        else
+          print_invalid_attempt(event->guess);
+        break;
+      case YK_EVENT_FEEDBACK:
+        hint_update(hints, event->guess, event->result);
+        if (json)
+          print_json_guess(event->guess, event->result, MAX_NUM_ATTEMPTS - event->attempt,
+                           hints->num_candidates);
+        else
+          print_attempt_result(event->guess, event->result);
+        break;
+      case YK_EVENT_FINISHED:
+        *outcome = event->outcome;
+        break;
+      }
+    }
+  }
+
+  return 1;
+}
+
+/* Everything a game session needs, loaded once before any session
+   starts. */
+typedef struct session {
+  const yk_dict_t *dict;
+  const char *todays_answer;
   player_stats_t stats;
+
+  /** Feedback of every valid guess against today's answer, shared by
+      all sessions. */
+  yk_daily_t daily;
+
+  /** Hint state before the first guess. Sessions in zygote mode each
+      run in their own process, so they never share it. */
+  hint_engine_t hints;
+
+  /** Best first and second guesses for the dictionary, used by the
+      hints and the analysis, or NULL if there is no book. */
+  const opening_book_t *book;
+
+  /** Non-zero if each guess is to be analyzed after the game. */
+  int analyze;
+
+  /** Non-zero to print the game as JSON Lines (see `play_game`),
+      without stats. */
+  int json;
+
+  /** The player's history, if it could be loaded (`stats.history` is
+      then set), and the number of games logged since its last
+      checkpoint. */
+  history_t history;
+  unsigned int num_unsaved;
+
+  /** In zygote mode, games finished by all sessions since the server
+      started, and how many of them have been saved by the parent, for
+      each day counted separately. The stats in `stats` are not changed
+      while the server runs, so they plus `counters` are always the
+      current stats (see `current_stats`). Otherwise, `counters.shards`
+      is NULL. */
+  outcome_counters_t counters;
+  uint64_t saved_counts[OUTCOME_DAYS][NUM_OUTCOMES];
+} session_t;
+
+/**
+   Adds the games counted in `counts` to stats.
+
+   @param stats the stats to be updated.
+
+   @param counts games with each outcome, indexed as in
+   `outcome_shard_t`.
+
+   @param except games to leave out, indexed like `counts`. May be
+   NULL.
+ */
+static void add_counts(player_stats_t *stats, const uint64_t counts[], const uint64_t except[]) {
+  for (int i = 0; i < NUM_OUTCOMES; i++) {
+    unsigned int count = counts[i] - (except != NULL ? except[i] : 0);
+    if (i < MAX_NUM_ATTEMPTS) stats->wins_per_num_attempts[i] += count;
+    else stats->num_missed_words += count;
+  }
+}
+
+/**
+   Computes the current stats of the player: in zygote mode, the stats
+   loaded when the server started plus the games finished since.
+ */
+static void current_stats(const session_t *session, player_stats_t *stats) {
+  uint64_t counts[NUM_OUTCOMES];
+
+  *stats = session->stats;
+  if (session->counters.shards == NULL) return;
+  for (int32_t day = 0; day < OUTCOME_DAYS; day++) {
+    outcome_counters_read(&session->counters, day, counts);
+    add_counts(stats, counts, NULL);
+  }
+}
+
+/**
+   Saves the games finished by sessions in zygote mode since the last
+   call to stats.txt and to the history. Run in the parent process, so
+   sessions never wait for the stats lock. Each game is logged with
+   the day it was played: this runs every few seconds, so the counters
+   of the previous day are always read before they are reused.
+ */
+static void save_counters(void *data) {
+  session_t *session = data;
+  uint64_t counts[OUTCOME_DAYS][NUM_OUTCOMES], added[NUM_OUTCOMES];
+  int32_t day = today();
+  player_stats_t stats;
+  history_t history;
+  unsigned int num_unsaved;
+
+  for (int32_t d = day - OUTCOME_DAYS + 1; d <= day; d++)
+    outcome_counters_read(&session->counters, d, counts[d % OUTCOME_DAYS]);
+  if (memcmp(counts, session->saved_counts, sizeof(counts)) == 0) return;
+
+  int lock = lock_stats();
+  load_stats(&stats);
+  for (int i = 0; i < OUTCOME_DAYS; i++) add_counts(&stats, counts[i], session->saved_counts[i]);
+  int saved = write_stats(&stats);
+
+  /* The history is loaded once, and the new games of each day are
+     appended, oldest day first. */
+  if (saved && session->stats.history != NULL) {
+    saved = load_history(&history, &num_unsaved);
+    if (saved) {
+      for (int32_t d = day - OUTCOME_DAYS + 1; saved && d <= day; d++) {
+        for (int i = 0; i < NUM_OUTCOMES; i++)
+          added[i] = counts[d % OUTCOME_DAYS][i] - session->saved_counts[d % OUTCOME_DAYS][i];
+        saved = save_history_games(&history, &num_unsaved, d, session->todays_answer, added);
+      }
+      history_free(&history);
+    }
+  }
+  unlock_stats(lock);
+
+  if (saved) memcpy(session->saved_counts, counts, sizeof(counts));
+  else perror("Error saving stats");
+}
+
+/**
+   Plays a full game in the terminal: shows the current stats, plays
+   the game, and updates and shows the stats again.
+
+   @returns the exit status of the program.
+ */
+static int run_session(void *data) {
+  session_t *session = data;
+  yk_machine_t machine;
+  unsigned int outcome = 0;
+
+  yk_machine_init_daily(&machine, &session->daily);
+
+  if (!session->json) {
+    player_stats_t stats;
+    current_stats(session, &stats);
+    print_stats(&stats);
+  }
+
+  if (!play_game(&machine, &session->hints, session->json, &outcome))
+    return 2;
+
+  if (session->json) {
+    print_json_finished(outcome, session->todays_answer);
+  } else {
+    printf("Correct word is: %s\n\n", session->todays_answer);
+
+    if (session->analyze) {
+      guess_analysis_t analysis[MAX_NUM_ATTEMPTS];
+      if (analyze_game_book(&machine.game, session->book, analysis))
+        print_analysis(analysis, machine.game.num_attempts);
+      else
+        perror("Error analyzing game");
+    }
+
+    if (session->stats.history != NULL)
+      print_answer_history(&session->history, session->todays_answer);
+  }
+
+  /* In zygote mode, the parent saves the game later. */
+  if (session->counters.shards != NULL) {
+    player_stats_t stats;
+
+    outcome_counters_add(&session->counters, today(), outcome);
+    if (!session->json) {
+      current_stats(session, &stats);
+      print_stats(&stats);
+    }
+    return 0;
+  }
+
+  /* Other sessions may have finished since the stats were loaded. */
+  int lock = lock_stats();
+  load_stats(&session->stats);
+  int saved = save_stats(&session->stats, outcome);
+  if (saved && session->stats.history != NULL) {
+    history_free(&session->history);
+    session->stats.history = NULL;
+    if (load_history(&session->history, &session->num_unsaved)) {
+      session->stats.history = &session->history;
+      saved = save_history(&session->history, session->num_unsaved, session->todays_answer, outcome);
+    }
+  }
+  unlock_stats(lock);
+
+  if (!saved) {
+    perror("Error saving stats");
+    return 1;
+  }
+
+  if (!session->json)
+    print_stats(&session->stats);
+
+  return 0;
+}
+
+/**
+   Plays practice games back to back in the terminal, until the input
+   ends. Answers are picked at random, and the dictionary and hint
+   state are reused, so each game starts immediately. Practice games
+   are not counted in the saved stats; the stats of the practice
+   session are shown after each game instead.
+
+   @returns the exit status of the program.
+ */
+static int run_practice(session_t *session, practice_t *practice) {
+  player_stats_t stats = { 0 };
+  char answer[WORD_SIZE + 1];
+  yk_machine_t machine;
+  unsigned int outcome = 0;
+
+  for (unsigned int num_game = 1;; num_game++) {
+    practice_next_answer(practice, answer);
+    if (!yk_machine_init(&machine, session->dict, answer)) {
+      perror("Error starting practice game");
+      return 1;
+    }
+    hint_reset(&session->hints);
+
+    if (session->json) {
+      if (!play_game(&machine, &session->hints, 1, &outcome))
+        return 0;
+      print_json_finished(outcome, answer);
+      continue;
+    }
+
+    printf("Practice game #%u\n\n", num_game);
+    if (!play_game(&machine, &session->hints, 0, &outcome))
+      return 0;
+
+    printf("Correct word is: %s\n\n", answer);
+
+    if (session->analyze) {
+      guess_analysis_t analysis[MAX_NUM_ATTEMPTS];
+      if (analyze_game_book(&machine.game, session->book, analysis))
+        print_analysis(analysis, machine.game.num_attempts);
+      else
+        perror("Error analyzing game");
+    }
+
+    if (outcome > MAX_NUM_ATTEMPTS) stats.num_missed_words++;
+    else stats.wins_per_num_attempts[outcome - 1]++;
+    print_stats(&stats);
+    printf("\n");
+  }
+}
+
+/**
+   Plays a tournament between strategy plugins and prints the results.
+   Every strategy plays the same answers: every word in the dictionary,
+   or `num_games` answers picked as in practice mode.
+
+   @returns the exit status of the program.
+ */
+static int play_tournament(const yk_dict_t *dict, const char *plugins[], unsigned int num_plugins,
+                           unsigned int num_games, uint64_t seed) {
+  tournament_entry_t entries[MAX_STRATEGIES];
+  packed_word_t *answers;
+  int status = 1;
+
+  for (unsigned int i = 0; i < num_plugins; i++) {
+    entries[i].strategy = load_strategy(plugins[i]);
+    if (entries[i].strategy == NULL) return 1;
+  }
+
+  if (num_games == 0) {
+    answers = dict->words;
+    num_games = dict->num_words;
+  } else {
+    practice_t practice;
+    alias_table_t priors;
+    char answer[WORD_SIZE + 1];
+    int weighted = load_priors(dict, &priors);
+
+    if (!weighted && errno != ENOENT) {
+      perror("Error reading answer priors");
+      return 1;
+    }
+    answers = malloc(num_games * sizeof(*answers));
+    if (answers == NULL) {
+      perror("Error preparing tournament");
+      return 1;
+    }
+    practice_init(&practice, dict, weighted ? &priors : NULL, seed);
+    for (unsigned int i = 0; i < num_games; i++) {
+      practice_next_answer(&practice, answer);
+      answers[i] = pack_word(answer);
+    }
+    if (weighted) alias_table_free(&priors);
+  }
+
+  if (run_tournament(dict, answers, num_games, entries, num_plugins)) status = 0;
+  else fprintf(stderr, "Some strategies failed to play every game\n");
+  print_tournament(entries, num_plugins);
+
+  if (answers != dict->words) free(answers);
+  return status;
+}
+
+int main(int argc, char *argv[]) {
+
+  yk_dict_t dict;
+  opening_book_t book;
   char todays_answer[WORD_SIZE + 2];
+  session_t session = { .dict = &dict, .todays_answer = todays_answer };
+  const char *zygote_socket = NULL;
+  const char *detect_log = NULL;
+  const char *report_file = NULL;
+  const char *matrix_file = NULL;
+  const char *pool_file = NULL;
+  int binary_report = 0;
+  int practice_mode = 0;
+  const char *plugins[MAX_STRATEGIES];
+  unsigned int num_plugins = 0, num_games = 0;
+  uint64_t seed = (uint64_t) time(NULL) << 20 ^ getpid();
+  unsigned int shard = 0, num_shards = 0;
+  int opt;
 
-  char current_attempt[WORD_SIZE + 2];
-  letter_result_t attempt_result[WORD_SIZE];
-  unsigned int attempt;
+  while ((opt = getopt(argc, argv, "ad:jm:n:pr:R:s:S:t:x:z:")) != -1) {
+    switch (opt) {
+    case 'a':
+      session.analyze = 1;
+      break;
+    case 'd':
+      detect_log = optarg;
+      break;
+    case 'j':
+      session.json = 1;
+      break;
+    case 'm':
+      matrix_file = optarg;
+      break;
+    case 'n':
+      num_games = strtoul(optarg, NULL, 10);
+      break;
+    case 'p':
+      practice_mode = 1;
+      break;
+    case 't':
+      if (num_plugins == MAX_STRATEGIES) {
+        fprintf(stderr, "At most %d strategies can play at once\n", MAX_STRATEGIES);
+        return 1;
+      }
+      plugins[num_plugins++] = optarg;
+      break;
+    case 'S':
+      seed = strtoull(optarg, NULL, 0);
+      break;
+    case 'r':
+    case 'R':
+      report_file = optarg;
+      binary_report = opt == 'R';
+      break;
+    case 's':
+      if (sscanf(optarg, "%u/%u", &shard, &num_shards) != 2 || shard >= num_shards) {
+        fprintf(stderr, "Invalid shard: %s (expected INDEX/COUNT, e.g. 0/4)\n", optarg);
+        return 1;
+      }
+      break;
+    case 'x':
+      pool_file = optarg;
+      break;
+    case 'z':
+      zygote_socket = optarg;
+      break;
+    default:
+      fprintf(stderr, "Usage: %s [-a] [-d log] [-j] [-m file] [-p [-S seed]] [-r file | -R file] [-s index/count]\n"
+              "       [-t plugin]... [-n games] [-S seed] [-x pool] [-z socket]\n", argv[0]);
+      return 1;
+    }
+  }
   
-  if (!load_valid_words(&valid_words)) {
+  if (!load_dictionary(&dict)) {
     perror("Error retrieving list of valid words");
     return 1;
   }
-  if (!load_todays_answer(todays_answer)) {
-    perror("Error retrieving today's answer");
-    return 1;
+
+  if (detect_log != NULL) {
+    if (!print_suspicious_players(&dict, detect_log)) {
+      perror("Error reading game log");
+      return 1;
+    }
+    return 0;
   }
 
-  load_stats(&stats);
-  print_stats(&stats);
+  if (matrix_file != NULL) {
+    if (!update_matrix(&dict, matrix_file)) {
+      perror("Error updating pattern matrix");
+      return 1;
+    }
+    return 0;
+  }
+
+  if (pool_file != NULL) {
+    if (!print_exact_strategy(&dict, pool_file)) {
+      perror("Error solving answer pool");
+      return 1;
+    }
+    return 0;
+  }
+
+  if (num_plugins > 0)
+    return play_tournament(&dict, plugins, num_plugins, num_games, seed);
+
+  if (report_file != NULL) {
+    int written = num_shards > 0
+      ? write_partial_report(&dict, report_file, shard, num_shards)
+      : write_report(&dict, report_file, binary_report);
+    if (!written) {
+      perror("Error writing report");
+      return 1;
+    }
+    return 0;
+  }
 
-  for (attempt = 1; attempt <= MAX_NUM_ATTEMPTS; attempt++) {
+  /* Only hints and the analysis use the opening book, so it is not
+     loaded, nor computed, for tournaments and reports. */
+  if (load_opening_book(&dict, &book))
+    session.book = &book;
+  else
+    perror("Error computing opening book");
 
-    do {
-      if (!read_attempt(attempt, current_attempt))
-        return 2;
-    } while (!attempt_is_valid(&valid_words, current_attempt));
+  if (practice_mode) {
+    practice_t practice;
+    alias_table_t priors;
+    int weighted = load_priors(&dict, &priors);
 
-    int correct = compare_result(todays_answer, current_attempt, attempt_result);
-    print_attempt_result(current_attempt, attempt_result);
-    if (correct) break;
+    if (!weighted && errno != ENOENT) {
+      perror("Error reading answer priors");
+      return 1;
+    }
+    if (!hint_init_book(&session.hints, &dict, session.book)) {
+      perror("Error preparing hints");
+      return 1;
+    }
+
+    if (!session.json)
+      printf("Practice mode (seed %llu)\n\n", (unsigned long long) seed);
+    practice_init(&practice, &dict, weighted ? &priors : NULL, seed);
+    return run_practice(&session, &practice);
   }
 
-  printf("Correct word is: %s\n\n", todays_answer);
+  if (!load_todays_answer(todays_answer) || !yk_daily_build(&session.daily, &dict, todays_answer)) {
+    perror("Error retrieving today's answer");
+    return 1;
+  }
 
-  if (!save_stats(&stats, attempt)) {
-    perror("Error saving stats");
+  if (!hint_init_book(&session.hints, &dict, session.book)) {
+    perror("Error preparing hints");
     return 1;
   }
 
-  print_stats(&stats);
+  load_stats(&session.stats);
+  if (load_history(&session.history, &session.num_unsaved))
+    session.stats.history = &session.history;
+  else
+    perror("Error reading history; streaks will not be shown");
 
-  return 0;
+  if (zygote_socket != NULL) {
+    if (!outcome_counters_init(&session.counters)) {
+      perror("Error creating stats counters");
+      return 1;
+    }
+    if (run_zygote(zygote_socket, run_session, save_counters, &session)) return 0;
+    perror("Error serving game sessions");
+    return 1;
+  }
+
+  return run_session(&session);
 }
@@ -0,0 +1,251 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "matrix.h"
+#include "parallel.h"
+
+/* Number of rows of a matrix filled by each parallel task. */
+#define ROWS_PER_TASK 64
+
+/* A run of consecutive answers whose column can be copied from the
+   previous version of a matrix, where they were also consecutive. */
+typedef struct column_run {
+  unsigned int start, old_start, length;
+} column_run_t;
+
+typedef struct update_job {
+  const yk_dict_t *dict;
+  const pattern_matrix_t *old;
+  pattern_t *patterns;
+
+  /** Index of each word of `dict` in `old`, or -1 if it is new. */
+  const long *old_index;
+
+  /** Columns that can be copied, and the answers that must be scored
+      (indices into `dict`, and the words themselves). */
+  const column_run_t *runs;
+  unsigned int num_runs;
+  const unsigned int *fresh;
+  const packed_word_t *fresh_words;
+  unsigned int num_fresh;
+} update_job_t;
+
+static void update_rows(unsigned int task, void *data) {
+  update_job_t *job = data;
+  unsigned int num_words = job->dict->num_words;
+  unsigned int end = (task + 1) * ROWS_PER_TASK;
+  pattern_t *scored = malloc(job->num_fresh ? job->num_fresh : 1);
+
+  if (end > num_words) end = num_words;
+  for (unsigned int g = task * ROWS_PER_TASK; g < end; g++) {
+    pattern_t *row = job->patterns + (size_t) g * num_words;
+    packed_word_t guess = job->dict->words[g];
+
+    if (job->old_index[g] < 0 || scored == NULL) {
+      batch_score_answers(guess, job->dict->words, num_words, row);
+      continue;
+    }
+
+    const pattern_t *old_row = job->old->patterns + (size_t) job->old_index[g] * job->old->num_words;
+    for (unsigned int r = 0; r < job->num_runs; r++)
+      memcpy(row + job->runs[r].start, old_row + job->runs[r].old_start, job->runs[r].length);
+
+    batch_score_answers(guess, job->fresh_words, job->num_fresh, scored);
+    for (unsigned int f = 0; f < job->num_fresh; f++) row[job->fresh[f]] = scored[f];
+  }
+  free(scored);
+}
+
+/**
+   Finds the index of each word of a dictionary in a previous version
+   of a matrix.
+
+   @param old_index where the index of each word is stored, or -1 if
+   the word is not in `old`.
+
+   @returns a non-zero value on success, or zero if memory could not
+   be allocated.
+ */
+static int map_words(const pattern_matrix_t *old, const yk_dict_t *dict, long old_index[]) {
+  uint32_t num_slots = 16;
+  while (num_slots < 2 * old->num_words) num_slots *= 2;
+
+  uint64_t *slots = calloc(num_slots, sizeof(*slots));
+  if (slots == NULL) return 0;
+
+  for (unsigned int i = 0; i < old->num_words; i++) {
+    uint32_t slot = (uint32_t) ((old->words[i] * 0x9e3779b97f4a7c15u) >> 32) & (num_slots - 1);
+    while (slots[slot] != 0) slot = (slot + 1) & (num_slots - 1);
+    slots[slot] = (uint64_t) old->words[i] << 32 | i;
+  }
+
+  for (unsigned int i = 0; i < dict->num_words; i++) {
+    uint32_t slot = (uint32_t) ((dict->words[i] * 0x9e3779b97f4a7c15u) >> 32) & (num_slots - 1);
+    old_index[i] = -1;
+    for (; slots[slot] != 0; slot = (slot + 1) & (num_slots - 1)) {
+      if (slots[slot] >> 32 == dict->words[i]) {
+        old_index[i] = (uint32_t) slots[slot];
+        break;
+      }
+    }
+  }
+
+  free(slots);
+  return 1;
+}
+
+/**
+   Initializes an empty matrix, for no words. Can be released with
+   `pattern_matrix_free`, and brought up to date with
+   `pattern_matrix_update`.
+ */
+void pattern_matrix_init(pattern_matrix_t *matrix) {
+  memset(matrix, 0, sizeof(*matrix));
+  matrix->dict_hash = yk_dict_hash(&(yk_dict_t) { .num_words = 0 });
+}
+
+/**
+   Releases the memory used by a matrix.
+ */
+void pattern_matrix_free(pattern_matrix_t *matrix) {
+  free(matrix->words);
+  free(matrix->patterns);
+  matrix->words = NULL;
+  matrix->patterns = NULL;
+  matrix->num_words = 0;
+}
+
+/**
+   Brings a matrix up to date with a new version of the dictionary.
+   Words that were already in the matrix keep their patterns, moved to
+   their new positions; only the rows and columns of words that were
+   added are scored, and those of words that were removed are
+   dropped. After a small edit of the word list, this is mostly a copy
+   of the previous matrix. Rows are filled in parallel.
+
+   @param matrix the matrix to be updated, initialized with
+   `pattern_matrix_init` or read with `pattern_matrix_read`. Not
+   changed if this function fails.
+
+   @param dict the new version of the dictionary.
+
+   @param num_reused where the number of words whose row and column
+   were copied from the previous version is stored. May be NULL.
+
+   @returns a non-zero value if the matrix was updated, or zero if
+   memory could not be allocated.
+ */
+int pattern_matrix_update(pattern_matrix_t *matrix, const yk_dict_t *dict, unsigned int *num_reused) {
+  unsigned int num_words = dict->num_words;
+  uint64_t dict_hash = yk_dict_hash(dict);
+  int result = 0;
+
+  if (num_reused != NULL) *num_reused = matrix->num_words;
+  if (dict_hash == matrix->dict_hash && num_words == matrix->num_words
+      && memcmp(dict->words, matrix->words, num_words * sizeof(*dict->words)) == 0)
+    return 1;
+
+  size_t size = num_words ? num_words : 1;
+  update_job_t job = { .dict = dict, .old = matrix };
+  packed_word_t *words = malloc(size * sizeof(*words));
+  pattern_t *patterns = malloc(size * size);
+  long *old_index = malloc(size * sizeof(*old_index));
+  column_run_t *runs = malloc(size * sizeof(*runs));
+  unsigned int *fresh = malloc(size * sizeof(*fresh));
+  packed_word_t *fresh_words = malloc(size * sizeof(*fresh_words));
+  if (words == NULL || patterns == NULL || old_index == NULL || runs == NULL || fresh == NULL
+      || fresh_words == NULL || !map_words(matrix, dict, old_index))
+    goto done;
+
+  for (unsigned int i = 0; i < num_words; i++) {
+    if (old_index[i] < 0) {
+      fresh[job.num_fresh] = i;
+      fresh_words[job.num_fresh++] = dict->words[i];
+    } else if (job.num_runs > 0 && runs[job.num_runs - 1].start + runs[job.num_runs - 1].length == i
+               && runs[job.num_runs - 1].old_start + runs[job.num_runs - 1].length == old_index[i]) {
+      runs[job.num_runs - 1].length++;
+    } else {
+      runs[job.num_runs++] = (column_run_t) { i, old_index[i], 1 };
+    }
+  }
+
+  job.patterns = patterns;
+  job.old_index = old_index;
+  job.runs = runs;
+  job.fresh = fresh;
+  job.fresh_words = fresh_words;
+  parallel_run((num_words + ROWS_PER_TASK - 1) / ROWS_PER_TASK, update_rows, &job);
+
+  if (num_reused != NULL) *num_reused = num_words - job.num_fresh;
+  memcpy(words, dict->words, num_words * sizeof(*words));
+  pattern_matrix_free(matrix);
+  matrix->words = words;
+  matrix->num_words = num_words;
+  matrix->dict_hash = dict_hash;
+  matrix->patterns = patterns;
+  words = NULL;
+  patterns = NULL;
+  result = 1;
+
+ done:
+  free(words);
+  free(patterns);
+  free(old_index);
+  free(runs);
+  free(fresh);
+  free(fresh_words);
+  return result;
+}
+
+/**
+   Writes a matrix: MATRIX_MAGIC, the number of words as a 32-bit
+   integer, the dictionary hash as a 64-bit integer, the packed words
+   and then the patterns, row by row, all in the machine's byte order.
+
+   @returns a non-zero value on success, or zero if the matrix could
+   not be written.
+ */
+int pattern_matrix_write(FILE *fh, const pattern_matrix_t *matrix) {
+  uint32_t num_words = matrix->num_words;
+  size_t num_patterns = (size_t) num_words * num_words;
+
+  return fwrite(MATRIX_MAGIC, 1, sizeof(MATRIX_MAGIC) - 1, fh) == sizeof(MATRIX_MAGIC) - 1
+    && fwrite(&num_words, sizeof(num_words), 1, fh) == 1
+    && fwrite(&matrix->dict_hash, sizeof(matrix->dict_hash), 1, fh) == 1
+    && fwrite(matrix->words, sizeof(*matrix->words), num_words, fh) == num_words
+    && fwrite(matrix->patterns, 1, num_patterns, fh) == num_patterns;
+}
+
+/**
+   Reads a matrix written by `pattern_matrix_write`.
+
+   @param matrix the struct where the matrix is stored. Must be
+   released with `pattern_matrix_free` if this function succeeds.
+
+   @returns a non-zero value if the matrix was read, or zero if it
+   could not be read, is truncated or its words do not match its
+   hash.
+ */
+int pattern_matrix_read(FILE *fh, pattern_matrix_t *matrix) {
+  char magic[sizeof(MATRIX_MAGIC) - 1];
+  uint32_t num_words;
+
+  pattern_matrix_init(matrix);
+  if (fread(magic, sizeof(magic), 1, fh) != 1 || memcmp(magic, MATRIX_MAGIC, sizeof(magic)) != 0
+      || fread(&num_words, sizeof(num_words), 1, fh) != 1
+      || fread(&matrix->dict_hash, sizeof(matrix->dict_hash), 1, fh) != 1)
+    return 0;
+
+  size_t num_patterns = (size_t) num_words * num_words;
+  matrix->num_words = num_words;
+  matrix->words = malloc((num_words ? num_words : 1) * sizeof(*matrix->words));
+  matrix->patterns = malloc(num_patterns ? num_patterns : 1);
+  if (matrix->words == NULL || matrix->patterns == NULL
+      || fread(matrix->words, sizeof(*matrix->words), num_words, fh) != num_words
+      || fread(matrix->patterns, 1, num_patterns, fh) != num_patterns || fgetc(fh) != EOF
+      || yk_dict_hash(&(yk_dict_t) { .words = matrix->words, .num_words = num_words }) != matrix->dict_hash) {
+    pattern_matrix_free(matrix);
+    return 0;
+  }
+  return 1;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "engine.h"
+
+/* First bytes of a pattern matrix written by `pattern_matrix_write`. */
+#define MATRIX_MAGIC "YKPM0001"
+
+typedef struct pattern_matrix {
+
+  /** Words the matrix was computed for, in dictionary order. Each word
+      is both a guess (a row) and an answer (a column). */
+  packed_word_t *words;
+  unsigned int num_words;
+
+  /** Hash of `words`, as given by `yk_dict_hash`. Identifies the
+      version of the dictionary the matrix belongs to. */
+  uint64_t dict_hash;
+
+  /** The feedback for every guess against every answer: `num_words`
+      rows of `num_words` patterns, the row of a guess holding its
+      pattern against each answer. */
+  pattern_t *patterns;
+} pattern_matrix_t;
+
+/**
+   @returns the pattern for the guess at index `guess` of the matrix
+   when the answer is the word at index `answer`.
+ */
+static inline pattern_t pattern_matrix_get(const pattern_matrix_t *matrix, unsigned int guess, unsigned int answer) {
+  return matrix->patterns[(size_t) guess * matrix->num_words + answer];
+}
+
+void pattern_matrix_init(pattern_matrix_t *);
+void pattern_matrix_free(pattern_matrix_t *);
+int pattern_matrix_update(pattern_matrix_t *, const yk_dict_t *, unsigned int *);
+
+int pattern_matrix_write(FILE *, const pattern_matrix_t *);
+int pattern_matrix_read(FILE *, pattern_matrix_t *);
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "shard.h"
+
+/**
+   Combines the partial reports written by `yorkle -s INDEX/COUNT` into
+   the report `yorkle -r` or `yorkle -R` would have written. All shards
+   must be given exactly once, in any order, and must have been
+   computed from the same word list.
+ */
+int main(int argc, char *argv[]) {
+  shard_header_t expected = { 0 };
+  word_report_t *rows = NULL;
+  unsigned char *seen = NULL;
+  int binary = 0, opt, status = 1;
+
+  while ((opt = getopt(argc, argv, "R")) != -1) {
+    if (opt != 'R') {
+      fprintf(stderr, "Usage: %s [-R] output partial...\n", argv[0]);
+      return 1;
+    }
+    binary = 1;
+  }
+  if (argc - optind < 2) {
+    fprintf(stderr, "Usage: %s [-R] output partial...\n", argv[0]);
+    return 1;
+  }
+
+  for (int i = optind + 1; i < argc; i++) {
+    shard_header_t header;
+    word_report_t *shard_rows;
+    FILE *fh = fopen(argv[i], "rb");
+
+    if (fh == NULL) {
+      perror(argv[i]);
+      goto done;
+    }
+    int read = shard_read(fh, &header, &shard_rows);
+    fclose(fh);
+    if (!read) {
+      fprintf(stderr, "%s: not a valid partial report\n", argv[i]);
+      goto done;
+    }
+
+    if (rows == NULL) {
+      expected = header;
+      rows = calloc(header.num_words ? header.num_words : 1, sizeof(*rows));
+      seen = calloc(header.num_shards, 1);
+      if (rows == NULL || seen == NULL) {
+        perror("Error merging reports");
+        free(shard_rows);
+        goto done;
+      }
+    } else if (header.dict_hash != expected.dict_hash || header.num_shards != expected.num_shards
+               || header.num_words != expected.num_words) {
+      fprintf(stderr, "%s: computed from a different word list or shard count\n", argv[i]);
+      free(shard_rows);
+      goto done;
+    }
+
+    if (seen[header.shard]) {
+      fprintf(stderr, "%s: shard %u given more than once\n", argv[i], header.shard);
+      free(shard_rows);
+      goto done;
+    }
+    seen[header.shard] = 1;
+    memcpy(rows + header.first, shard_rows, header.num_rows * sizeof(*rows));
+    free(shard_rows);
+  }
+
+  for (unsigned int shard = 0; shard < expected.num_shards; shard++) {
+    if (!seen[shard]) {
+      fprintf(stderr, "Missing shard %u of %u\n", shard, expected.num_shards);
+      goto done;
+    }
+  }
+
+  const char *output = argv[optind];
+  FILE *fh = strcmp(output, "-") == 0 ? stdout : fopen(output, binary ? "wb" : "w");
+  if (fh == NULL) {
+    perror(output);
+    goto done;
+  }
+  int written = binary ? report_write_binary(fh, rows, expected.num_words)
+                       : report_write_csv(fh, rows, expected.num_words);
+  written = (fh == stdout ? fflush(fh) : fclose(fh)) == 0 && written;
+  if (!written) {
+    perror(output);
+    goto done;
+  }
+  status = 0;
+
+ done:
+  free(rows);
+  free(seen);
+  return status;
+}
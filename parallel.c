@@ -0,0 +1,76 @@
+#include <pthread.h>
+#include <unistd.h>
+
+#include "parallel.h"
+
+/* Upper bound on the number of threads used by `parallel_run`. */
+#define MAX_THREADS 64
+
+/* Set in threads while they run tasks, so that `parallel_run` called
+   from within a task runs inline instead of starting more threads. */
+static __thread int inside_task;
+
+typedef struct job {
+  unsigned int num_tasks;
+  unsigned int next_task;
+  parallel_task_t task;
+  void *data;
+} job_t;
+
+static void *worker(void *arg) {
+  job_t *job = arg;
+  int was_inside = inside_task;
+
+  inside_task = 1;
+  for (;;) {
+    unsigned int task = __atomic_fetch_add(&job->next_task, 1, __ATOMIC_RELAXED);
+    if (task >= job->num_tasks) break;
+    job->task(task, job->data);
+  }
+  inside_task = was_inside;
+  return NULL;
+}
+
+/**
+   @returns the number of threads used by `parallel_run`: one per
+   online processor, up to a fixed limit.
+ */
+unsigned int parallel_num_threads(void) {
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  if (cpus < 1) return 1;
+  return cpus > MAX_THREADS ? MAX_THREADS : cpus;
+}
+
+/**
+   Runs `task` for every task number from 0 to `num_tasks - 1`, spread
+   over one thread per processor, and waits for all of them to
+   finish. Threads take the next task as soon as they finish the
+   previous one, so tasks of uneven cost are balanced. The calling
+   thread takes part, so tasks still run if no threads can be
+   created. When called from within a task, all tasks run in the
+   calling thread, since all processors are already busy.
+
+   @param num_tasks the number of tasks to be run.
+
+   @param task function run for each task.
+
+   @param data value passed to `task`.
+ */
+void parallel_run(unsigned int num_tasks, parallel_task_t task, void *data) {
+  job_t job = { .num_tasks = num_tasks, .task = task, .data = data };
+  pthread_t threads[MAX_THREADS];
+  unsigned int num_threads = parallel_num_threads();
+  unsigned int started = 0;
+
+  if (num_threads > num_tasks) num_threads = num_tasks;
+  if (inside_task) num_threads = 1;
+
+  for (unsigned int i = 1; i < num_threads; i++) {
+    if (pthread_create(&threads[started], NULL, worker, &job) != 0) break;
+    started++;
+  }
+
+  worker(&job);
+
+  for (unsigned int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+}
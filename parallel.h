@@ -0,0 +1,11 @@
+#pragma once
+
+/**
+   Function run for each task by `parallel_run`. Tasks may run in any
+   order and in any thread, so they must only share read-only data or
+   write to separate locations.
+ */
+typedef void (*parallel_task_t)(unsigned int task, void *data);
+
+unsigned int parallel_num_threads(void);
+void parallel_run(unsigned int, parallel_task_t, void *);
@@ -0,0 +1,147 @@
+#include <stdlib.h>
+#include <errno.h>
+
+#include "practice.h"
+
+/**
+   Returns the next pseudo-random number from a practice generator
+   (SplitMix64). The sequence only depends on the seed given to
+   `practice_init`.
+ */
+uint64_t practice_random(practice_t *practice) {
+  uint64_t z = (practice->state += 0x9e3779b97f4a7c15u);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9u;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebu;
+  return z ^ (z >> 31);
+}
+
+/**
+   @returns a pseudo-random number from 0 to `bound - 1`, without bias.
+   `bound` must not be zero.
+ */
+unsigned int practice_random_below(practice_t *practice, unsigned int bound) {
+  uint64_t product = (practice_random(practice) >> 32) * bound;
+
+  /* Reject the few values that would make low results more likely. */
+  if ((uint32_t) product < bound) {
+    uint32_t threshold = -bound % bound;
+    while ((uint32_t) product < threshold) product = (practice_random(practice) >> 32) * bound;
+  }
+  return product >> 32;
+}
+
+/**
+   Builds an alias table (Vose's method), so that items can be picked
+   at random with the given weights in constant time.
+
+   @param table the struct to be initialized. Must be released with
+   `alias_table_free` if this function succeeds.
+
+   @param weights the weight of each item. Must not be negative, and
+   at least one must be positive.
+
+   @param num_items the number of items in `weights`.
+
+   @returns a non-zero value if the table was built, or zero if memory
+   could not be allocated or the weights are invalid (errno is then
+   set to EINVAL).
+ */
+int alias_table_init(alias_table_t *table, const double weights[], unsigned int num_items) {
+  double total = 0;
+
+  for (unsigned int i = 0; i < num_items && total >= 0; i++)
+    total = weights[i] >= 0 ? total + weights[i] : -1;
+  if (!(total > 0)) {
+    errno = EINVAL;
+    return 0;
+  }
+
+  table->num_items = num_items;
+  table->probabilities = malloc(num_items * sizeof(*table->probabilities));
+  table->aliases = malloc(num_items * sizeof(*table->aliases));
+  unsigned int *work = malloc(num_items * sizeof(*work));
+  if (table->probabilities == NULL || table->aliases == NULL || work == NULL) {
+    free(work);
+    alias_table_free(table);
+    return 0;
+  }
+
+  /* Items with less than the average weight are stacked at the start
+     of `work`, the others at the end. Each small item is paired with a
+     large one, which gives up the rest of the slot. */
+  unsigned int num_small = 0, large = num_items;
+  for (unsigned int i = 0; i < num_items; i++) {
+    table->probabilities[i] = weights[i] * num_items / total;
+    table->aliases[i] = i;
+    if (table->probabilities[i] < 1) work[num_small++] = i;
+    else work[--large] = i;
+  }
+
+  while (num_small > 0 && large < num_items) {
+    unsigned int small = work[--num_small], big = work[large];
+    table->aliases[small] = big;
+    table->probabilities[big] -= 1 - table->probabilities[small];
+    if (table->probabilities[big] < 1) {
+      large++;
+      work[num_small++] = big;
+    }
+  }
+
+  /* Whatever is left only differs from 1 by rounding errors. */
+  for (unsigned int i = 0; i < num_small; i++) table->probabilities[work[i]] = 1;
+  for (unsigned int i = large; i < num_items; i++) table->probabilities[work[i]] = 1;
+
+  free(work);
+  return 1;
+}
+
+void alias_table_free(alias_table_t *table) {
+  free(table->probabilities);
+  free(table->aliases);
+  table->probabilities = NULL;
+  table->aliases = NULL;
+  table->num_items = 0;
+}
+
+/**
+   @returns a random item from an alias table, picked with the weights
+   given to `alias_table_init`.
+ */
+unsigned int alias_table_pick(const alias_table_t *table, practice_t *practice) {
+  unsigned int slot = practice_random_below(practice, table->num_items);
+  double coin = (practice_random(practice) >> 11) * 0x1p-53;
+  return coin < table->probabilities[slot] ? slot : table->aliases[slot];
+}
+
+/**
+   Prepares to pick answers for practice games from a dictionary.
+
+   @param practice the struct to be initialized.
+
+   @param dict the dictionary the answers are picked from. Must not be
+   empty, and must not be released while `practice` is in use.
+
+   @param weights if not NULL, a table with one weight for each word in
+   the dictionary, in order. Otherwise, all words are equally likely.
+
+   @param seed the seed of the pseudo-random number generator. The same
+   seed gives the same answers.
+ */
+void practice_init(practice_t *practice, const yk_dict_t *dict, alias_table_t *weights, uint64_t seed) {
+  practice->dict = dict;
+  practice->state = seed;
+  practice->weights = weights;
+}
+
+/**
+   Picks the answer for the next practice game.
+
+   @param answer an array where the answer is stored as a string. Must
+   have space for at least WORD_SIZE+1 characters.
+ */
+void practice_next_answer(practice_t *practice, char answer[]) {
+  unsigned int index = practice->weights != NULL
+    ? alias_table_pick(practice->weights, practice)
+    : practice_random_below(practice, practice->dict->num_words);
+  unpack_word(practice->dict->words[index], answer);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "engine.h"
+
+typedef struct alias_table {
+
+  /** For each slot, the probability of picking the slot's own item
+      rather than its alias, and the alias. */
+  double *probabilities;
+  unsigned int *aliases;
+  unsigned int num_items;
+} alias_table_t;
+
+typedef struct practice {
+  const yk_dict_t *dict;
+
+  /** State of the pseudo-random number generator. */
+  uint64_t state;
+
+  /** Table used to pick answers with the given weights, or NULL to
+      pick them uniformly. */
+  alias_table_t *weights;
+} practice_t;
+
+uint64_t practice_random(practice_t *);
+unsigned int practice_random_below(practice_t *, unsigned int);
+
+int alias_table_init(alias_table_t *, const double[], unsigned int);
+void alias_table_free(alias_table_t *);
+unsigned int alias_table_pick(const alias_table_t *, practice_t *);
+
+void practice_init(practice_t *, const yk_dict_t *, alias_table_t *, uint64_t);
+void practice_next_answer(practice_t *, char[]);
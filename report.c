@@ -0,0 +1,154 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "report.h"
+#include "solver.h"
+#include "parallel.h"
+
+/* Number of guesses profiled by each parallel task. */
+#define GUESSES_PER_TASK 64
+
+/* Number of patterns computed at once, so that the buffer stays on the
+   stack and in cache. */
+#define CHUNK_SIZE 2048
+
+/* Number of copies of the histogram updated in turn. Consecutive
+   patterns are often equal, and incrementing the same counter back
+   to back stalls on the previous store; spreading them over separate
+   copies lets the increments overlap. */
+#define HISTOGRAM_COPIES 4
+
+typedef struct report_job {
+  const yk_dict_t *dict;
+
+  /* Rows for the words at positions `first` to `end - 1` of the
+     dictionary. */
+  word_report_t *rows;
+  unsigned int first, end;
+} report_job_t;
+
+static void profile_guesses(unsigned int task, void *data) {
+  report_job_t *job = data;
+  const packed_word_t *words = job->dict->words;
+  unsigned int num_words = job->dict->num_words;
+  unsigned int end = job->first + (task + 1) * GUESSES_PER_TASK;
+  pattern_t patterns[CHUNK_SIZE];
+
+  /* Private to this task, so threads never share counters. */
+  unsigned int histograms[HISTOGRAM_COPIES][NUM_PATTERNS];
+
+  if (end > job->end) end = job->end;
+  for (unsigned int g = job->first + task * GUESSES_PER_TASK; g < end; g++) {
+    memset(histograms, 0, sizeof(histograms));
+
+    for (unsigned int start = 0; start < num_words; start += CHUNK_SIZE) {
+      unsigned int size = num_words - start < CHUNK_SIZE ? num_words - start : CHUNK_SIZE;
+      batch_score_answers(words[g], words + start, size, patterns);
+
+      unsigned int i = 0;
+      for (; i + HISTOGRAM_COPIES <= size; i += HISTOGRAM_COPIES)
+        for (int c = 0; c < HISTOGRAM_COPIES; c++) histograms[c][patterns[i + c]]++;
+      for (; i < size; i++) histograms[0][patterns[i]]++;
+    }
+
+    for (int c = 1; c < HISTOGRAM_COPIES; c++)
+      for (int p = 0; p < NUM_PATTERNS; p++) histograms[0][p] += histograms[c][p];
+
+    word_report_t *row = &job->rows[g - job->first];
+    row->word = words[g];
+    row->num_buckets = 0;
+    row->largest_bucket = 0;
+    for (int p = 0; p < NUM_PATTERNS; p++) {
+      row->num_buckets += histograms[0][p] > 0;
+      if (histograms[0][p] > row->largest_bucket) row->largest_bucket = histograms[0][p];
+    }
+    row->entropy = histogram_entropy(histograms[0], num_words);
+  }
+}
+
+/**
+   Profiles some of the words in the dictionary, both as a guess and as
+   an answer, with all words in the dictionary as possible answers.
+   Words are processed in parallel. Profiling disjoint ranges separately
+   gives the same rows as `build_report`.
+
+   @param dict the dictionary to be profiled.
+
+   @param first the position in the dictionary of the first word to be
+   profiled.
+
+   @param end one past the position in the dictionary of the last word
+   to be profiled. Must not be greater than `dict->num_words`.
+
+   @param rows an array where the profile of each word is stored, in
+   dictionary order. Must have space for `end - first` elements.
+
+   @returns a non-zero value on success, or zero if memory could not
+   be allocated.
+ */
+int build_report_range(const yk_dict_t *dict, unsigned int first, unsigned int end, word_report_t rows[]) {
+  report_job_t job = { .dict = dict, .rows = rows, .first = first, .end = end };
+  unsigned int num_words = dict->num_words;
+
+  if (first >= end) return 1;
+
+  /* Rows are written to files as raw structs, padding included, so it
+     is cleared for the files to be reproducible. */
+  memset(rows, 0, (end - first) * sizeof(*rows));
+  parallel_run((end - first + GUESSES_PER_TASK - 1) / GUESSES_PER_TASK, profile_guesses, &job);
+
+  unsigned char *attempts = malloc(num_words);
+  if (attempts == NULL) return 0;
+
+  int result = solve_range(dict->words, num_words, dict->words, num_words, first, end, attempts);
+  for (unsigned int i = first; i < end; i++) rows[i - first].solver_guesses = attempts[i];
+
+  free(attempts);
+  return result;
+}
+
+/**
+   Profiles every word in the dictionary. Same as `build_report_range`
+   over all words.
+
+   @returns a non-zero value on success, or zero if memory could not
+   be allocated.
+ */
+int build_report(const yk_dict_t *dict, word_report_t rows[]) {
+  return build_report_range(dict, 0, dict->num_words, rows);
+}
+
+/**
+   Writes report rows as CSV, after a header line naming the columns.
+
+   @returns a non-zero value on success, or zero if the rows could not
+   be written.
+ */
+int report_write_csv(FILE *fh, const word_report_t rows[], unsigned int num_rows) {
+  char word[WORD_SIZE + 1];
+
+  fprintf(fh, "word,buckets,largest_bucket,entropy,solver_guesses\n");
+  for (unsigned int i = 0; i < num_rows; i++) {
+    unpack_word(rows[i].word, word);
+    fprintf(fh, "%s,%u,%u,%.4lf,%u\n", word, rows[i].num_buckets, rows[i].largest_bucket,
+            rows[i].entropy, rows[i].solver_guesses);
+  }
+  return !ferror(fh);
+}
+
+/**
+   Writes report rows in binary: REPORT_MAGIC, the number of rows as a
+   32-bit integer, and then each row as a `word_report_t`, in the
+   machine's byte order.
+
+   @returns a non-zero value on success, or zero if the rows could not
+   be written.
+ */
+int report_write_binary(FILE *fh, const word_report_t rows[], unsigned int num_rows) {
+  uint32_t count = num_rows;
+
+  return fwrite(REPORT_MAGIC, 1, sizeof(REPORT_MAGIC) - 1, fh) == sizeof(REPORT_MAGIC) - 1
+    && fwrite(&count, sizeof(count), 1, fh) == 1
+    && fwrite(rows, sizeof(*rows), num_rows, fh) == num_rows;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdio.h>
+
+#include "engine.h"
+
+/* First bytes of a report written in binary. */
+#define REPORT_MAGIC "YKRP0001"
+
+typedef struct word_report {
+  packed_word_t word;
+
+  /** Partition of all words in the dictionary by the feedback they
+      give to this word as a guess: number of non-empty buckets, size
+      of the largest one, and entropy in bits. */
+  unsigned int num_buckets;
+  unsigned int largest_bucket;
+  double entropy;
+
+  /** Number of guesses the built-in greedy solver (`best_guess` at
+      every step, starting from the same first guess) needs when this
+      word is the answer. This reflects that one strategy only, not
+      how hard the word is for players or for other strategies. */
+  unsigned int solver_guesses;
+} word_report_t;
+
+int build_report_range(const yk_dict_t *, unsigned int, unsigned int, word_report_t[]);
+int build_report(const yk_dict_t *, word_report_t[]);
+
+int report_write_csv(FILE *, const word_report_t[], unsigned int);
+int report_write_binary(FILE *, const word_report_t[], unsigned int);
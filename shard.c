@@ -0,0 +1,87 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "shard.h"
+
+/**
+   Computes which items belong to a shard when `num_items` items are
+   split into `num_shards` shards of nearly equal size. The split only
+   depends on the arguments, so separate processes, possibly on
+   different hosts, agree on it.
+
+   @param num_items the number of items to be split.
+
+   @param shard the index of the shard, from 0 to `num_shards - 1`.
+
+   @param num_shards the number of shards.
+
+   @param first where the index of the first item in the shard is
+   stored.
+
+   @param end where one past the index of the last item in the shard is
+   stored. Equal to `first` if the shard is empty.
+ */
+void shard_range(unsigned int num_items, unsigned int shard, unsigned int num_shards,
+                 unsigned int *first, unsigned int *end) {
+  *first = (uint64_t)num_items * shard / num_shards;
+  *end = (uint64_t)num_items * (shard + 1) / num_shards;
+}
+
+/**
+   Writes a partial report: SHARD_MAGIC, the fields of `header` as
+   32-bit and 64-bit integers in the order they are declared, and then
+   `header->num_rows` rows as `word_report_t`, all in the machine's
+   byte order.
+
+   @returns a non-zero value on success, or zero if the report could
+   not be written.
+ */
+int shard_write(FILE *fh, const shard_header_t *header, const word_report_t rows[]) {
+  uint32_t fields[] = { header->shard, header->num_shards, header->num_words, header->first, header->num_rows };
+
+  return fwrite(SHARD_MAGIC, 1, sizeof(SHARD_MAGIC) - 1, fh) == sizeof(SHARD_MAGIC) - 1
+    && fwrite(&header->dict_hash, sizeof(header->dict_hash), 1, fh) == 1
+    && fwrite(fields, sizeof(fields), 1, fh) == 1
+    && fwrite(rows, sizeof(*rows), header->num_rows, fh) == header->num_rows;
+}
+
+/**
+   Reads a partial report written by `shard_write`, checking that it is
+   complete and consistent with the split made by `shard_range`.
+
+   @param header where the header of the report is stored.
+
+   @param rows where a pointer to the rows of the report is stored.
+   The rows must be released with `free` if this function succeeds.
+
+   @returns a non-zero value if the report was read, or zero if it
+   could not be read, is truncated or is not a valid partial report.
+ */
+int shard_read(FILE *fh, shard_header_t *header, word_report_t **rows) {
+  char magic[sizeof(SHARD_MAGIC) - 1];
+  uint32_t fields[5];
+  unsigned int first, end;
+
+  if (fread(magic, sizeof(magic), 1, fh) != 1 || memcmp(magic, SHARD_MAGIC, sizeof(magic)) != 0
+      || fread(&header->dict_hash, sizeof(header->dict_hash), 1, fh) != 1
+      || fread(fields, sizeof(fields), 1, fh) != 1)
+    return 0;
+
+  header->shard = fields[0];
+  header->num_shards = fields[1];
+  header->num_words = fields[2];
+  header->first = fields[3];
+  header->num_rows = fields[4];
+  if (header->shard >= header->num_shards) return 0;
+
+  shard_range(header->num_words, header->shard, header->num_shards, &first, &end);
+  if (header->first != first || header->num_rows != end - first) return 0;
+
+  *rows = malloc((header->num_rows ? header->num_rows : 1) * sizeof(**rows));
+  if (*rows == NULL) return 0;
+  if (fread(*rows, sizeof(**rows), header->num_rows, fh) != header->num_rows || fgetc(fh) != EOF) {
+    free(*rows);
+    return 0;
+  }
+  return 1;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "report.h"
+
+/* First bytes of a partial report written by `shard_write`. */
+#define SHARD_MAGIC "YKSH0001"
+
+typedef struct shard_header {
+
+  /** Hash of the dictionary the rows were computed from, as given by
+      `yk_dict_hash`. Partial reports can only be merged if they were
+      computed from the same dictionary. */
+  uint64_t dict_hash;
+
+  /** Index of this shard, from 0 to `num_shards - 1`. */
+  uint32_t shard;
+  uint32_t num_shards;
+
+  /** Number of words in the dictionary, and the position of the first
+      word in this shard. */
+  uint32_t num_words;
+  uint32_t first;
+
+  /** Number of rows in this shard. */
+  uint32_t num_rows;
+} shard_header_t;
+
+void shard_range(unsigned int, unsigned int, unsigned int, unsigned int *, unsigned int *);
+
+int shard_write(FILE *, const shard_header_t *, const word_report_t[]);
+int shard_read(FILE *, shard_header_t *, word_report_t **);
@@ -0,0 +1,548 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <time.h>
+
+#include "solver.h"
+#include "parallel.h"
+
+/* Number of patterns computed at once when scanning candidates, so
+   that the buffer stays on the stack and in cache. */
+#define CHUNK_SIZE 1024
+
+/* Number of guesses evaluated by each parallel task. */
+#define GUESSES_PER_TASK 128
+
+/**
+   Keeps only the candidates that would give `pattern` as feedback for
+   `guess`, i.e., those that may still be the answer.
+
+   @param candidates the current candidates.
+
+   @param num_candidates the number of items in `candidates`.
+
+   @param guess the packed guessed word.
+
+   @param pattern the feedback received for the guess.
+
+   @param remaining an array where the remaining candidates are stored,
+   in the same order. Must have space for `num_candidates` elements.
+   May be the same array as `candidates`.
+
+   @returns the number of candidates stored in `remaining`.
+ */
+unsigned int filter_candidates(const packed_word_t candidates[], unsigned int num_candidates,
+                               packed_word_t guess, pattern_t pattern, packed_word_t remaining[]) {
+  pattern_t patterns[CHUNK_SIZE];
+  unsigned int count = 0;
+
+  for (unsigned int start = 0; start < num_candidates; start += CHUNK_SIZE) {
+    unsigned int size = num_candidates - start < CHUNK_SIZE ? num_candidates - start : CHUNK_SIZE;
+    batch_score_answers(guess, candidates + start, size, patterns);
+    for (unsigned int i = 0; i < size; i++) {
+      remaining[count] = candidates[start + i];
+      count += patterns[i] == pattern;
+    }
+  }
+  return count;
+}
+
+/**
+   Counts how many candidates give each feedback pattern for a guess.
+
+   @param histogram an array where the counts are stored. Must have
+   space for NUM_PATTERNS elements.
+ */
+void pattern_histogram(packed_word_t guess, const packed_word_t candidates[], unsigned int num_candidates,
+                       unsigned int histogram[]) {
+  pattern_t patterns[CHUNK_SIZE];
+
+  memset(histogram, 0, NUM_PATTERNS * sizeof(histogram[0]));
+  for (unsigned int start = 0; start < num_candidates; start += CHUNK_SIZE) {
+    unsigned int size = num_candidates - start < CHUNK_SIZE ? num_candidates - start : CHUNK_SIZE;
+    batch_score_answers(guess, candidates + start, size, patterns);
+    for (unsigned int i = 0; i < size; i++) histogram[patterns[i]]++;
+  }
+}
+
+/**
+   Computes the entropy, in bits, of the partition of `total`
+   candidates described by a histogram. This is the expected
+   information gained by the guess that produced the histogram.
+ */
+double histogram_entropy(const unsigned int histogram[], unsigned int total) {
+  double sum = 0;
+
+  if (total == 0) return 0;
+  for (int i = 0; i < NUM_PATTERNS; i++)
+    if (histogram[i] > 1) sum += histogram[i] * log2(histogram[i]);
+
+  return log2(total) - sum / total;
+}
+
+/**
+   @returns the expected information, in bits, gained by a guess when
+   the answer is one of the candidates.
+ */
+double guess_entropy(packed_word_t guess, const packed_word_t candidates[], unsigned int num_candidates) {
+  unsigned int histogram[NUM_PATTERNS];
+  pattern_histogram(guess, candidates, num_candidates, histogram);
+  return histogram_entropy(histogram, num_candidates);
+}
+
+typedef struct scored_guess {
+  double entropy;
+  int is_candidate;
+  unsigned int index;
+} scored_guess_t;
+
+/**
+   @returns a non-zero value if `a` is a better guess than `b`: higher
+   entropy first, then guesses that may be the answer, then the one
+   listed first. Ties are broken by position so that the result does
+   not depend on the number of threads.
+ */
+static int better_guess(const scored_guess_t *a, const scored_guess_t *b) {
+  if (a->entropy != b->entropy) return a->entropy > b->entropy;
+  if (a->is_candidate != b->is_candidate) return a->is_candidate;
+  return a->index < b->index;
+}
+
+typedef struct search {
+  const packed_word_t *guesses;
+  const unsigned int *indices;
+  unsigned int num_guesses;
+  const packed_word_t *candidates;
+  unsigned int num_candidates;
+  scored_guess_t *scores;
+
+  /* `xlogx[c]` is `c * log2(c)`, for every bucket size `c` up to
+     `num_candidates`. */
+  double *xlogx;
+
+  /* For small candidate sets, the pattern of every guess against
+     every candidate, one row per candidate. NULL otherwise. */
+  pattern_t *patterns;
+
+  /* Time by which the search must end, or NULL, and whether it has
+     passed. */
+  const struct timespec *deadline;
+  int timed_out;
+} search_t;
+
+/**
+   @returns whether the deadline of the search has passed. Once it
+   has, every task stops at its next check.
+ */
+static int past_deadline(search_t *search) {
+  struct timespec now;
+
+  if (search->deadline == NULL) return 0;
+  if (__atomic_load_n(&search->timed_out, __ATOMIC_RELAXED)) return 1;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (now.tv_sec < search->deadline->tv_sec
+      || (now.tv_sec == search->deadline->tv_sec && now.tv_nsec < search->deadline->tv_nsec))
+    return 0;
+  __atomic_store_n(&search->timed_out, 1, __ATOMIC_RELAXED);
+  return 1;
+}
+
+/**
+   Computes the entropy of the partition given by a histogram of
+   `search->num_candidates` words.
+ */
+static double search_entropy(const search_t *search, const unsigned int histogram[]) {
+  double sum = 0;
+  for (int i = 0; i < NUM_PATTERNS; i++) sum += search->xlogx[histogram[i]];
+  return log2(search->num_candidates) - sum / search->num_candidates;
+}
+
+static void score_guesses(unsigned int task, void *data) {
+  search_t *search = data;
+  unsigned int histogram[NUM_PATTERNS];
+  unsigned int end = (task + 1) * GUESSES_PER_TASK;
+
+  if (past_deadline(search)) return;
+  if (end > search->num_guesses) end = search->num_guesses;
+  for (unsigned int i = task * GUESSES_PER_TASK; i < end; i++) {
+    unsigned int index = search->indices ? search->indices[i] : i;
+    pattern_histogram(search->guesses[index], search->candidates, search->num_candidates, histogram);
+    search->scores[i].entropy = search_entropy(search, histogram);
+    search->scores[i].is_candidate = histogram[PATTERN_SOLVED] > 0;
+    search->scores[i].index = index;
+  }
+}
+
+/**
+   Same as `score_guesses`, reading the patterns from
+   `search->patterns`. Only the buckets that are used are visited, so
+   that few candidates cost little.
+ */
+static void score_guesses_small(unsigned int task, void *data) {
+  search_t *search = data;
+  unsigned int n = search->num_candidates;
+  unsigned char counts[NUM_PATTERNS] = { 0 };
+  pattern_t used[SOLVER_SMALL_SET_SIZE];
+  unsigned int end = (task + 1) * GUESSES_PER_TASK;
+
+  if (past_deadline(search)) return;
+  if (end > search->num_guesses) end = search->num_guesses;
+  for (unsigned int g = task * GUESSES_PER_TASK; g < end; g++) {
+    unsigned int num_used = 0;
+    int is_candidate = 0;
+    for (unsigned int c = 0; c < n; c++) {
+      pattern_t pattern = search->patterns[(size_t) c * search->num_guesses + g];
+      used[num_used] = pattern;
+      num_used += counts[pattern]++ == 0;
+      is_candidate |= pattern == PATTERN_SOLVED;
+    }
+
+    double sum = 0;
+    for (unsigned int u = 0; u < num_used; u++) {
+      sum += search->xlogx[counts[used[u]]];
+      counts[used[u]] = 0;
+    }
+    search->scores[g].entropy = log2(n) - sum / n;
+    search->scores[g].is_candidate = is_candidate;
+    search->scores[g].index = g;
+  }
+}
+
+/**
+   Scores the guesses in `search` against its candidates in parallel.
+   If `search->indices` is set, only the guesses at those positions are
+   scored.
+ */
+static void run_search(search_t *search) {
+  for (unsigned int c = 0; c <= search->num_candidates; c++)
+    search->xlogx[c] = c > 1 ? c * log2(c) : 0;
+  parallel_run((search->num_guesses + GUESSES_PER_TASK - 1) / GUESSES_PER_TASK,
+               search->patterns ? score_guesses_small : score_guesses, search);
+}
+
+static int compare_scores(const void *a, const void *b) {
+  return better_guess(a, b) ? -1 : better_guess(b, a) ? 1 : 0;
+}
+
+/**
+   Looks for a candidate whose feedback is different for every
+   candidate. Such a guess has the highest possible entropy, and may
+   also be the answer, so no other guess can be better.
+
+   @returns the first such candidate, or zero if there is none.
+ */
+static packed_word_t perfect_candidate(const packed_word_t candidates[], unsigned int num_candidates) {
+  pattern_t patterns[NUM_PATTERNS];
+
+  if (num_candidates > NUM_PATTERNS) return 0;
+
+  for (unsigned int c = 0; c < num_candidates; c++) {
+    uint64_t seen[(NUM_PATTERNS + 63) / 64] = { 0 };
+    unsigned int i;
+
+    batch_score_answers(candidates[c], candidates, num_candidates, patterns);
+    for (i = 0; i < num_candidates; i++) {
+      uint64_t bit = UINT64_C(1) << (patterns[i] % 64);
+      if (seen[patterns[i] / 64] & bit) break;
+      seen[patterns[i] / 64] |= bit;
+    }
+    if (i == num_candidates) return candidates[c];
+  }
+  return 0;
+}
+
+/**
+   Finds the guess that gives the most information about the answer,
+   i.e., the one whose feedback has the highest entropy over the
+   current candidates. Guesses are scored in parallel.
+
+   If a candidate gives different feedback for every candidate, the
+   first such candidate is returned without scoring other guesses.
+   With at most SOLVER_SMALL_SET_SIZE candidates, each candidate is
+   scored against all guesses at once, which keeps the vector kernel
+   busy however few candidates there are. With more than
+   SOLVER_SAMPLE_SIZE candidates, guesses are first ranked against a
+   sample of the candidates, and only the best SOLVER_SHORTLIST_SIZE
+   are scored against all of them. The result is then the best guess
+   of the shortlist, which is almost always the overall best, at a
+   small fraction of the cost.
+
+   @param guesses the words that may be guessed.
+
+   @param num_guesses the number of items in `guesses`.
+
+   @param candidates the words that may still be the answer.
+
+   @param num_candidates the number of items in `candidates`.
+
+   @param entropy if not NULL, where the entropy of the best guess is
+   stored.
+
+   @returns the best guess, or zero if there are no guesses or memory
+   could not be allocated.
+ */
+packed_word_t best_guess(const packed_word_t guesses[], unsigned int num_guesses,
+                         const packed_word_t candidates[], unsigned int num_candidates, double *entropy) {
+  return best_guess_until(guesses, num_guesses, candidates, num_candidates, NULL, entropy);
+}
+
+/**
+   Same as `best_guess`, but gives up if the search is not finished by
+   a deadline. Tasks check the clock before each batch of guesses, so
+   the search ends shortly after it.
+
+   @param deadline the time, on the CLOCK_MONOTONIC clock, by which the
+   search must end, or NULL to search until it is finished.
+
+   @returns the best guess, or zero if there are no guesses, memory
+   could not be allocated, or the deadline passed (errno is set to
+   ETIMEDOUT).
+ */
+packed_word_t best_guess_until(const packed_word_t guesses[], unsigned int num_guesses,
+                               const packed_word_t candidates[], unsigned int num_candidates,
+                               const struct timespec *deadline, double *entropy) {
+  search_t search = { .guesses = guesses, .num_guesses = num_guesses,
+                      .candidates = candidates, .num_candidates = num_candidates, .deadline = deadline };
+  packed_word_t *sample = NULL;
+  unsigned int *shortlist = NULL;
+  packed_word_t best = 0;
+
+  if (entropy != NULL) *entropy = 0;
+  if (num_guesses == 0) return 0;
+
+  /* With one or two candidates, guessing one of them is optimal. */
+  if (num_candidates > 0 && num_candidates <= 2) {
+    if (entropy != NULL) *entropy = num_candidates == 2 ? 1 : 0;
+    return candidates[0];
+  }
+
+  best = perfect_candidate(candidates, num_candidates);
+  if (best != 0) {
+    if (entropy != NULL) *entropy = log2(num_candidates);
+    return best;
+  }
+
+  unsigned int sample_size = num_candidates > SOLVER_SAMPLE_SIZE ? SOLVER_SAMPLE_SIZE : num_candidates;
+  search.scores = malloc(num_guesses * sizeof(*search.scores));
+  search.xlogx = malloc((num_candidates + 1) * sizeof(*search.xlogx));
+  if (search.scores == NULL || search.xlogx == NULL) goto done;
+
+  if (num_candidates <= SOLVER_SMALL_SET_SIZE) {
+    search.patterns = malloc((size_t) num_candidates * num_guesses);
+    if (search.patterns == NULL) goto done;
+    for (unsigned int c = 0; c < num_candidates; c++) {
+      if (past_deadline(&search)) goto timed_out;
+      batch_score_guesses(guesses, num_guesses, candidates[c], search.patterns + (size_t) c * num_guesses);
+    }
+  }
+
+  if (num_candidates > sample_size) {
+    sample = malloc(sample_size * sizeof(*sample));
+    shortlist = malloc(SOLVER_SHORTLIST_SIZE * sizeof(*shortlist));
+    if (sample == NULL || shortlist == NULL) goto done;
+
+    for (unsigned int i = 0; i < sample_size; i++)
+      sample[i] = candidates[(unsigned long) i * num_candidates / sample_size];
+
+    search.candidates = sample;
+    search.num_candidates = sample_size;
+    run_search(&search);
+    if (search.timed_out) goto timed_out;
+
+    unsigned int shortlist_size = num_guesses < SOLVER_SHORTLIST_SIZE ? num_guesses : SOLVER_SHORTLIST_SIZE;
+    qsort(search.scores, num_guesses, sizeof(*search.scores), compare_scores);
+    for (unsigned int i = 0; i < shortlist_size; i++) shortlist[i] = search.scores[i].index;
+
+    search.indices = shortlist;
+    search.num_guesses = shortlist_size;
+    search.candidates = candidates;
+    search.num_candidates = num_candidates;
+  }
+
+  run_search(&search);
+  if (search.timed_out) goto timed_out;
+
+  scored_guess_t *top = &search.scores[0];
+  for (unsigned int i = 1; i < search.num_guesses; i++)
+    if (better_guess(&search.scores[i], top)) top = &search.scores[i];
+
+  best = guesses[top->index];
+  if (entropy != NULL) *entropy = top->entropy;
+  goto done;
+
+ timed_out:
+  errno = ETIMEDOUT;
+
+ done:
+  free(search.scores);
+  free(search.xlogx);
+  free(search.patterns);
+  free(sample);
+  free(shortlist);
+  return best;
+}
+
+typedef struct solve_tree {
+  const packed_word_t *guesses;
+  unsigned int num_guesses;
+  const packed_word_t *answers;
+  unsigned char *num_attempts;
+
+  /* Answers (by position in `answers`) grouped by the feedback to the
+     first guess; the answers of group `i` are at positions
+     `group_starts[i]` to `group_starts[i + 1] - 1` of `order`. */
+  unsigned int *order;
+  unsigned int group_starts[NUM_PATTERNS + 1];
+
+  /* Only answers at positions `first` to `end - 1` of `answers` are
+     needed, so subtrees without any of them are skipped. */
+  unsigned int first, end;
+
+  /* Set if any group could not be solved. */
+  int failed;
+} solve_tree_t;
+
+/* Checks if any of the answers in `indices` is needed. */
+static int any_wanted(const solve_tree_t *tree, const unsigned int indices[], unsigned int num_indices) {
+  for (unsigned int i = 0; i < num_indices; i++)
+    if (indices[i] >= tree->first && indices[i] < tree->end) return 1;
+  return 0;
+}
+
+/**
+   Plays every answer in `indices` with the solver, given that
+   `depth` guesses have already been made and only these answers are
+   left. Answers with the same feedback follow the same path, so each
+   node of the solver's decision tree is only computed once.
+
+   @returns a non-zero value on success, or zero if memory could not
+   be allocated.
+ */
+static int solve_node(solve_tree_t *tree, unsigned int indices[], unsigned int num_indices, unsigned int depth) {
+  unsigned int counts[NUM_PATTERNS] = { 0 }, starts[NUM_PATTERNS];
+  int result = 0;
+
+  if (num_indices <= 1) {
+    if (num_indices == 1) tree->num_attempts[indices[0]] = depth + 1;
+    return 1;
+  }
+
+  packed_word_t *candidates = malloc(num_indices * sizeof(*candidates));
+  pattern_t *patterns = malloc(num_indices * sizeof(*patterns));
+  unsigned int *sorted = malloc(num_indices * sizeof(*sorted));
+  if (candidates == NULL || patterns == NULL || sorted == NULL) goto done;
+
+  for (unsigned int i = 0; i < num_indices; i++) candidates[i] = tree->answers[indices[i]];
+
+  packed_word_t guess = best_guess(tree->guesses, tree->num_guesses, candidates, num_indices, NULL);
+  if (guess == 0) goto done;
+
+  batch_score_answers(guess, candidates, num_indices, patterns);
+  for (unsigned int i = 0; i < num_indices; i++) counts[patterns[i]]++;
+  for (unsigned int p = 0, start = 0; p < NUM_PATTERNS; p++) {
+    starts[p] = start;
+    start += counts[p];
+  }
+  for (unsigned int i = 0; i < num_indices; i++) sorted[starts[patterns[i]]++] = indices[i];
+
+  result = 1;
+  for (unsigned int p = 0, start = 0; p < NUM_PATTERNS && result; start += counts[p], p++) {
+    if (counts[p] == 0 || !any_wanted(tree, sorted + start, counts[p])) continue;
+    if (p == PATTERN_SOLVED) tree->num_attempts[sorted[start]] = depth + 1;
+    else result = solve_node(tree, sorted + start, counts[p], depth + 1);
+  }
+
+ done:
+  free(candidates);
+  free(patterns);
+  free(sorted);
+  return result;
+}
+
+static void solve_group(unsigned int task, void *data) {
+  solve_tree_t *tree = data;
+  unsigned int start = tree->group_starts[task], end = tree->group_starts[task + 1];
+
+  if (start == end || !any_wanted(tree, tree->order + start, end - start)) return;
+  if (task == PATTERN_SOLVED) tree->num_attempts[tree->order[start]] = 1;
+  else if (!solve_node(tree, tree->order + start, end - start, 1))
+    __atomic_store_n(&tree->failed, 1, __ATOMIC_RELAXED);
+}
+
+/**
+   Computes how many guesses the solver needs to find some of the
+   answers, always playing `best_guess` with all answers as
+   candidates. Only the parts of the solver's decision tree that lead
+   to the requested answers are computed, so disjoint ranges can be
+   computed separately and give the same results as `solve_all`.
+   Subtrees for each feedback to the first guess are solved in
+   parallel.
+
+   @param guesses the words that may be guessed.
+
+   @param num_guesses the number of items in `guesses`.
+
+   @param answers the words that may be the answer.
+
+   @param num_answers the number of items in `answers`.
+
+   @param first the position in `answers` of the first answer needed.
+
+   @param end one past the position in `answers` of the last answer
+   needed.
+
+   @param num_attempts an array where the number of guesses needed for
+   each answer is stored, indexed by position in `answers`. Only the
+   entries from `first` to `end - 1` are set.
+
+   @returns a non-zero value on success, or zero if memory could not
+   be allocated.
+ */
+int solve_range(const packed_word_t guesses[], unsigned int num_guesses,
+                const packed_word_t answers[], unsigned int num_answers,
+                unsigned int first, unsigned int end, unsigned char num_attempts[]) {
+  solve_tree_t tree = { .guesses = guesses, .num_guesses = num_guesses, .answers = answers,
+                        .num_attempts = num_attempts, .first = first, .end = end };
+  unsigned int counts[NUM_PATTERNS] = { 0 };
+  int result = 0;
+
+  if (first >= end) return 1;
+
+  pattern_t *patterns = malloc(num_answers * sizeof(*patterns));
+  tree.order = malloc(num_answers * sizeof(*tree.order));
+  if (patterns == NULL || tree.order == NULL) goto done;
+
+  packed_word_t opener = best_guess(guesses, num_guesses, answers, num_answers, NULL);
+  if (opener == 0) goto done;
+
+  batch_score_answers(opener, answers, num_answers, patterns);
+  for (unsigned int i = 0; i < num_answers; i++) counts[patterns[i]]++;
+  tree.group_starts[0] = 0;
+  for (unsigned int p = 0; p < NUM_PATTERNS; p++) tree.group_starts[p + 1] = tree.group_starts[p] + counts[p];
+
+  unsigned int next[NUM_PATTERNS];
+  memcpy(next, tree.group_starts, sizeof(next));
+  for (unsigned int i = 0; i < num_answers; i++) tree.order[next[patterns[i]]++] = i;
+
+  parallel_run(NUM_PATTERNS, solve_group, &tree);
+  result = !tree.failed;
+
+ done:
+  free(patterns);
+  free(tree.order);
+  return result;
+}
+
+/**
+   Computes how many guesses the solver needs to find each answer,
+   always playing `best_guess`. Same as `solve_range` over all answers.
+
+   @returns a non-zero value on success, or zero if memory could not
+   be allocated.
+ */
+int solve_all(const packed_word_t guesses[], unsigned int num_guesses,
+              const packed_word_t answers[], unsigned int num_answers, unsigned char num_attempts[]) {
+  return solve_range(guesses, num_guesses, answers, num_answers, 0, num_answers, num_attempts);
+}
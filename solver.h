@@ -0,0 +1,30 @@
+#pragma once
+
+#include <time.h>
+
+#include "batch.h"
+
+/* When there are more candidates than this, `best_guess` first ranks
+   all guesses against an evenly spaced sample of this many candidates,
+   and only evaluates the best SOLVER_SHORTLIST_SIZE of them against
+   all candidates. */
+#define SOLVER_SAMPLE_SIZE    1024
+#define SOLVER_SHORTLIST_SIZE 64
+
+/* With at most this many candidates, `best_guess` scores each
+   candidate against all guesses at once instead. */
+#define SOLVER_SMALL_SET_SIZE 128
+
+unsigned int filter_candidates(const packed_word_t[], unsigned int, packed_word_t, pattern_t, packed_word_t[]);
+
+void pattern_histogram(packed_word_t, const packed_word_t[], unsigned int, unsigned int[]);
+double histogram_entropy(const unsigned int[], unsigned int);
+double guess_entropy(packed_word_t, const packed_word_t[], unsigned int);
+
+packed_word_t best_guess(const packed_word_t[], unsigned int, const packed_word_t[], unsigned int, double *);
+packed_word_t best_guess_until(const packed_word_t[], unsigned int, const packed_word_t[], unsigned int,
+                               const struct timespec *, double *);
+
+int solve_range(const packed_word_t[], unsigned int, const packed_word_t[], unsigned int,
+                unsigned int, unsigned int, unsigned char[]);
+int solve_all(const packed_word_t[], unsigned int, const packed_word_t[], unsigned int, unsigned char[]);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "engine.h"
+
+/* Version of the strategy interface. Plugins built for another version
+   are rejected. */
+#define YK_STRATEGY_VERSION 1
+
+/* Name of the function a strategy plugin exports, which returns its
+   `yk_strategy_t`. */
+#define YK_STRATEGY_SYMBOL "yk_strategy"
+
+/**
+   A guessing strategy, loaded from a shared object that exports a
+   function named YK_STRATEGY_SYMBOL:
+
+       const yk_strategy_t *yk_strategy(void);
+
+   Games are played in parallel, so all functions but `init` and
+   `destroy` may be called from several threads at once, each with a
+   different game.
+
+   Plugins are linked against the library code exported by yorkle,
+   not a copy of their own, so `parallel_run` called from a strategy
+   runs inline in the thread playing the game, and the processor time
+   of each move is measured on that thread alone. Strategies should
+   not start threads of their own: their time would not be counted.
+ */
+typedef struct yk_strategy {
+
+  /** Must be YK_STRATEGY_VERSION. */
+  unsigned int version;
+
+  /** Short name shown in results. */
+  const char *name;
+
+  /** Prepares anything shared by all games with a dictionary, such as
+      a precomputed first guess. Returns the shared state, which is
+      passed to `new_game`, or NULL on error. */
+  void *(*init)(const yk_dict_t *dict);
+
+  /** Starts a game, in which any word in the dictionary may be the
+      answer. Returns the state of the game, or NULL on error. */
+  void *(*new_game)(void *shared);
+
+  /** Stores the next guess in `guess`, which has space for
+      WORD_SIZE+1 characters, as a zero-terminated string. Returns zero
+      to give up the game. */
+  int (*next_guess)(void *game, char guess[]);
+
+  /** Receives the feedback for the last guess. */
+  void (*observe)(void *game, const char guess[], const letter_result_t result[]);
+
+  /** Releases the state of a game. */
+  void (*end_game)(void *game);
+
+  /** Releases the shared state. */
+  void (*destroy)(void *shared);
+} yk_strategy_t;
+
+typedef const yk_strategy_t *(*yk_strategy_entry_t)(void);
@@ -0,0 +1,74 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "strategy.h"
+#include "solver.h"
+
+/* Strategy plugin that always plays the first word, in dictionary
+   order, that may still be the answer. A baseline that costs almost
+   nothing per move. */
+
+typedef struct game {
+  const yk_dict_t *dict;
+  packed_word_t *candidates;
+  unsigned int num_candidates;
+} game_t;
+
+static void *init(const yk_dict_t *dict) {
+  return (void *) dict;
+}
+
+static void *new_game(void *data) {
+  const yk_dict_t *dict = data;
+  game_t *game = malloc(sizeof(*game));
+  if (game == NULL) return NULL;
+
+  game->dict = dict;
+  game->num_candidates = dict->num_words;
+  game->candidates = malloc((dict->num_words ? dict->num_words : 1) * sizeof(*game->candidates));
+  if (game->candidates == NULL) {
+    free(game);
+    return NULL;
+  }
+  memcpy(game->candidates, dict->words, dict->num_words * sizeof(*game->candidates));
+  return game;
+}
+
+static int next_guess(void *data, char guess[]) {
+  game_t *game = data;
+
+  if (game->num_candidates == 0) return 0;
+  unpack_word(game->candidates[0], guess);
+  return 1;
+}
+
+static void observe(void *data, const char guess[], const letter_result_t result[]) {
+  game_t *game = data;
+  game->num_candidates = filter_candidates(game->candidates, game->num_candidates, pack_word(guess),
+                                           pattern_from_result(result), game->candidates);
+}
+
+static void end_game(void *data) {
+  game_t *game = data;
+  free(game->candidates);
+  free(game);
+}
+
+static void destroy(void *data) {
+  (void) data;
+}
+
+static const yk_strategy_t strategy = {
+  .version = YK_STRATEGY_VERSION,
+  .name = "first-candidate",
+  .init = init,
+  .new_game = new_game,
+  .next_guess = next_guess,
+  .observe = observe,
+  .end_game = end_game,
+  .destroy = destroy
+};
+
+const yk_strategy_t *yk_strategy(void) {
+  return &strategy;
+}
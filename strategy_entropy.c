@@ -0,0 +1,99 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "strategy.h"
+#include "solver.h"
+#include "book.h"
+
+/* Strategy plugin that always plays the guess expected to give the
+   most information, as found by `best_guess`. The first two guesses
+   are taken from the opening book saved by the game, if it matches the
+   dictionary. */
+
+typedef struct shared {
+  const yk_dict_t *dict;
+  packed_word_t first_guess;
+  opening_book_t book;
+  int has_book;
+} shared_t;
+
+typedef struct game {
+  const shared_t *shared;
+  packed_word_t *candidates;
+  unsigned int num_candidates;
+  unsigned int num_guesses;
+  pattern_t first_pattern;
+} game_t;
+
+static void *init(const yk_dict_t *dict) {
+  shared_t *shared = malloc(sizeof(*shared));
+  if (shared == NULL) return NULL;
+
+  shared->dict = dict;
+  shared->has_book = opening_book_load(&shared->book, dict, OPENING_BOOK_FILENAME);
+  shared->first_guess = shared->has_book
+    ? shared->book.first_guess
+    : best_guess(dict->words, dict->num_words, dict->words, dict->num_words, NULL);
+  return shared;
+}
+
+static void *new_game(void *data) {
+  const shared_t *shared = data;
+  game_t *game = malloc(sizeof(*game));
+  if (game == NULL) return NULL;
+
+  game->shared = shared;
+  game->num_candidates = shared->dict->num_words;
+  game->num_guesses = 0;
+  game->candidates = malloc((game->num_candidates ? game->num_candidates : 1) * sizeof(*game->candidates));
+  if (game->candidates == NULL) {
+    free(game);
+    return NULL;
+  }
+  memcpy(game->candidates, shared->dict->words, game->num_candidates * sizeof(*game->candidates));
+  return game;
+}
+
+static int next_guess(void *data, char guess[]) {
+  game_t *game = data;
+  const yk_dict_t *dict = game->shared->dict;
+  packed_word_t packed = game->num_guesses == 0
+    ? game->shared->first_guess
+    : opening_book_guess(game->shared->has_book ? &game->shared->book : NULL, game->num_guesses,
+                         game->shared->first_guess, game->first_pattern);
+
+  if (packed == 0)
+    packed = best_guess(dict->words, dict->num_words, game->candidates, game->num_candidates, NULL);
+
+  if (packed == 0 || game->num_candidates == 0) return 0;
+  unpack_word(packed, guess);
+  return 1;
+}
+
+static void observe(void *data, const char guess[], const letter_result_t result[]) {
+  game_t *game = data;
+  if (game->num_guesses++ == 0) game->first_pattern = pattern_from_result(result);
+  game->num_candidates = filter_candidates(game->candidates, game->num_candidates, pack_word(guess),
+                                           pattern_from_result(result), game->candidates);
+}
+
+static void end_game(void *data) {
+  game_t *game = data;
+  free(game->candidates);
+  free(game);
+}
+
+static const yk_strategy_t strategy = {
+  .version = YK_STRATEGY_VERSION,
+  .name = "entropy",
+  .init = init,
+  .new_game = new_game,
+  .next_guess = next_guess,
+  .observe = observe,
+  .end_game = end_game,
+  .destroy = free
+};
+
+const yk_strategy_t *yk_strategy(void) {
+  return &strategy;
+}
@@ -0,0 +1,100 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "strategy.h"
+#include "solver.h"
+#include "lookahead.h"
+#include "book.h"
+
+/* Strategy plugin that plays the guess leaving the fewest candidates
+   two guesses ahead, as found by `lookahead_guess`. The first guess,
+   and any guess with more than LOOKAHEAD_MAX_CANDIDATES candidates,
+   is the one expected to give the most information instead, taken
+   from the opening book saved by the game if it matches the
+   dictionary. */
+
+typedef struct shared {
+  const yk_dict_t *dict;
+  packed_word_t first_guess;
+} shared_t;
+
+typedef struct game {
+  const shared_t *shared;
+  packed_word_t *candidates;
+  unsigned int num_candidates;
+  unsigned int num_guesses;
+} game_t;
+
+static void *init(const yk_dict_t *dict) {
+  opening_book_t book;
+  shared_t *shared = malloc(sizeof(*shared));
+  if (shared == NULL) return NULL;
+
+  shared->dict = dict;
+  shared->first_guess = opening_book_load(&book, dict, OPENING_BOOK_FILENAME)
+    ? book.first_guess
+    : best_guess(dict->words, dict->num_words, dict->words, dict->num_words, NULL);
+  return shared;
+}
+
+static void *new_game(void *data) {
+  const shared_t *shared = data;
+  game_t *game = malloc(sizeof(*game));
+  if (game == NULL) return NULL;
+
+  game->shared = shared;
+  game->num_candidates = shared->dict->num_words;
+  game->num_guesses = 0;
+  game->candidates = malloc((game->num_candidates ? game->num_candidates : 1) * sizeof(*game->candidates));
+  if (game->candidates == NULL) {
+    free(game);
+    return NULL;
+  }
+  memcpy(game->candidates, shared->dict->words, game->num_candidates * sizeof(*game->candidates));
+  return game;
+}
+
+static int next_guess(void *data, char guess[]) {
+  game_t *game = data;
+  const yk_dict_t *dict = game->shared->dict;
+  packed_word_t packed;
+
+  if (game->num_guesses == 0)
+    packed = game->shared->first_guess;
+  else if (game->num_candidates > LOOKAHEAD_MAX_CANDIDATES)
+    packed = best_guess(dict->words, dict->num_words, game->candidates, game->num_candidates, NULL);
+  else
+    packed = lookahead_guess(dict->words, dict->num_words, game->candidates, game->num_candidates, NULL);
+
+  if (packed == 0 || game->num_candidates == 0) return 0;
+  unpack_word(packed, guess);
+  return 1;
+}
+
+static void observe(void *data, const char guess[], const letter_result_t result[]) {
+  game_t *game = data;
+  game->num_guesses++;
+  game->num_candidates = filter_candidates(game->candidates, game->num_candidates, pack_word(guess),
+                                           pattern_from_result(result), game->candidates);
+}
+
+static void end_game(void *data) {
+  game_t *game = data;
+  free(game->candidates);
+  free(game);
+}
+
+static const yk_strategy_t strategy = {
+  .version = YK_STRATEGY_VERSION,
+  .name = "lookahead",
+  .init = init,
+  .new_game = new_game,
+  .next_guess = next_guess,
+  .observe = observe,
+  .end_game = end_game,
+  .destroy = free
+};
+
+const yk_strategy_t *yk_strategy(void) {
+  return &strategy;
+}
@@ -0,0 +1,294 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "token.h"
+
+/* Game state in tokens that clients hand back with each guess, so that
+   any server can continue a game without keeping sessions. Encoding
+   and decoding never allocate: a word is turned into its index with
+   one hash table probe, the state is encrypted so that clients cannot
+   read the answer, and the signature is a short keyed hash of the
+   encrypted state. */
+
+typedef unsigned __int128 token_bits_t;
+
+#define ROTATE(x, n) ((x) << (n) | (x) >> (64 - (n)))
+
+#define SIP_ROUND(v0, v1, v2, v3) do {                                 \
+    v0 += v1; v1 = ROTATE(v1, 13); v1 ^= v0; v0 = ROTATE(v0, 32);     \
+    v2 += v3; v3 = ROTATE(v3, 16); v3 ^= v2;                          \
+    v0 += v3; v3 = ROTATE(v3, 21); v3 ^= v0;                          \
+    v2 += v1; v1 = ROTATE(v1, 17); v1 ^= v2; v2 = ROTATE(v2, 32);     \
+  } while (0)
+
+/**
+   Computes SipHash-2-4 of a 16-byte message given as two 64-bit
+   words, in little-endian order.
+ */
+static uint64_t siphash16(const uint64_t key[], uint64_t m0, uint64_t m1) {
+  uint64_t v0 = key[0] ^ 0x736f6d6570736575u;
+  uint64_t v1 = key[1] ^ 0x646f72616e646f6du;
+  uint64_t v2 = key[0] ^ 0x6c7967656e657261u;
+  uint64_t v3 = key[1] ^ 0x7465646279746573u;
+  uint64_t last = (uint64_t) 16 << 56;
+
+  v3 ^= m0; SIP_ROUND(v0, v1, v2, v3); SIP_ROUND(v0, v1, v2, v3); v0 ^= m0;
+  v3 ^= m1; SIP_ROUND(v0, v1, v2, v3); SIP_ROUND(v0, v1, v2, v3); v0 ^= m1;
+  v3 ^= last; SIP_ROUND(v0, v1, v2, v3); SIP_ROUND(v0, v1, v2, v3); v0 ^= last;
+
+  v2 ^= 0xff;
+  for (int i = 0; i < 4; i++) SIP_ROUND(v0, v1, v2, v3);
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/* Computes the signature of the (encrypted) state bits of a token. */
+static uint64_t token_mac(const yk_token_codec_t *codec, token_bits_t state) {
+  return siphash16(codec->key, (uint64_t) state, (uint64_t) (state >> 64)) >> (64 - YK_TOKEN_MAC_BITS);
+}
+
+/* The state is split into a low half of CIPHER_LOW_BITS and a high
+   half holding the rest, and each round of the cipher adds a keyed
+   hash of one half to the other. */
+#define CIPHER_ROUNDS 4
+#define CIPHER_LOW_BITS (YK_TOKEN_STATE_BITS / 2)
+#define CIPHER_HIGH_BITS (YK_TOKEN_STATE_BITS - CIPHER_LOW_BITS)
+
+#if CIPHER_HIGH_BITS > 64
+#error "token state halves do not fit in 64 bits"
+#endif
+
+/**
+   Computes the round function of the cipher: SipHash of one half of
+   the state and the round number. Bit 63 of the second word is set,
+   which it never is in the state signed by `token_mac`, so the two
+   uses of the key never hash the same message.
+ */
+static uint64_t cipher_round(const yk_token_codec_t *codec, unsigned int round, uint64_t half) {
+  return siphash16(codec->key, half, (uint64_t) 1 << 63 | round);
+}
+
+/**
+   Encrypts or decrypts the state bits of a token with a keyed Feistel
+   permutation of YK_TOKEN_STATE_BITS bits, so that every bit of the
+   result depends on every bit of the state and of the key.
+
+   @param decrypt zero to encrypt, non-zero to decrypt, which runs the
+   rounds in reverse order.
+ */
+static token_bits_t token_cipher(const yk_token_codec_t *codec, token_bits_t state, int decrypt) {
+  const uint64_t low_mask = ((uint64_t) 1 << CIPHER_LOW_BITS) - 1;
+  const uint64_t high_mask = CIPHER_HIGH_BITS == 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << CIPHER_HIGH_BITS) - 1;
+  uint64_t low = (uint64_t) state & low_mask;
+  uint64_t high = (uint64_t) (state >> CIPHER_LOW_BITS) & high_mask;
+
+  for (unsigned int i = 0; i < CIPHER_ROUNDS; i++) {
+    unsigned int round = decrypt ? CIPHER_ROUNDS - 1 - i : i;
+    if (round % 2 == 0) high ^= cipher_round(codec, round, low) & high_mask;
+    else low ^= cipher_round(codec, round, high) & low_mask;
+  }
+  return (token_bits_t) high << CIPHER_LOW_BITS | low;
+}
+
+/* Slot in the index table where the search for a packed word
+   starts. */
+static uint32_t index_home(const yk_token_codec_t *codec, packed_word_t word) {
+  return (uint32_t) ((word * 0x9e3779b97f4a7c15u) >> 32) & codec->mask;
+}
+
+/**
+   Finds the index of a word in the dictionary of a codec.
+
+   @returns the index of `word`, or -1 if it is not in the dictionary.
+ */
+static long word_index(const yk_token_codec_t *codec, packed_word_t word) {
+  if (word == 0) return -1;
+
+  for (uint32_t slot = index_home(codec, word);; slot = (slot + 1) & codec->mask) {
+    uint64_t entry = codec->slots[slot];
+    if (entry == 0) return -1;
+    if (entry >> 32 == word) return (uint32_t) entry;
+  }
+}
+
+/**
+   Prepares to encode and decode tokens for games played with one
+   dictionary. Every server that may continue the same games must use
+   the same dictionary, in the same order, and the same key.
+
+   @param codec the struct to be initialized. Must be released with
+   `yk_token_codec_free` if this function succeeds.
+
+   @param dict the dictionary of valid guesses. Must not be released
+   while the codec is in use.
+
+   @param key the secret key used to sign tokens, as two 64-bit
+   words. Should be random, and not known by clients.
+
+   @returns a non-zero value if the codec was initialized, or zero if
+   memory could not be allocated or the dictionary has more than
+   YK_TOKEN_MAX_WORDS words (errno is set to EOVERFLOW).
+ */
+int yk_token_codec_init(yk_token_codec_t *codec, const yk_dict_t *dict, const uint64_t key[]) {
+  if (dict->num_words > YK_TOKEN_MAX_WORDS) {
+    errno = EOVERFLOW;
+    return 0;
+  }
+
+  /* At most half the slots are used, to keep probe sequences short. */
+  uint32_t num_slots = 16;
+  while (num_slots < 2 * dict->num_words) num_slots *= 2;
+
+  codec->slots = calloc(num_slots, sizeof(*codec->slots));
+  if (codec->slots == NULL) return 0;
+
+  codec->dict = dict;
+  codec->key[0] = key[0];
+  codec->key[1] = key[1];
+  codec->mask = num_slots - 1;
+
+  for (unsigned int i = 0; i < dict->num_words; i++) {
+    uint32_t slot = index_home(codec, dict->words[i]);
+    while (codec->slots[slot] != 0) slot = (slot + 1) & codec->mask;
+    codec->slots[slot] = (uint64_t) dict->words[i] << 32 | i;
+  }
+  return 1;
+}
+
+/**
+   Releases the memory used by a codec initialized with
+   `yk_token_codec_init`.
+ */
+void yk_token_codec_free(yk_token_codec_t *codec) {
+  free(codec->slots);
+  codec->slots = NULL;
+}
+
+/**
+   Encodes the state of a game as an encrypted and signed token.
+
+   @param game the game, which must have been played with the
+   dictionary of the codec.
+
+   @param token where the token is stored.
+
+   @returns a non-zero value if the token was created, or zero if the
+   answer is not in the dictionary (errno is set to EINVAL).
+ */
+int yk_token_encode(const yk_token_codec_t *codec, const yk_game_t *game, yk_token_t *token) {
+  long answer = word_index(codec, pack_word(game->answer));
+  if (answer < 0) {
+    errno = EINVAL;
+    return 0;
+  }
+
+  token_bits_t state = game->num_attempts | (token_bits_t) answer << YK_TOKEN_COUNT_BITS;
+  for (unsigned int i = 0; i < game->num_attempts; i++) {
+    long guess = word_index(codec, pack_word(game->guesses[i]));
+    if (guess < 0) {
+      errno = EINVAL;
+      return 0;
+    }
+    state |= (token_bits_t) guess << (YK_TOKEN_COUNT_BITS + (i + 1) * YK_TOKEN_INDEX_BITS);
+  }
+
+  state = token_cipher(codec, state, 0);
+  state |= (token_bits_t) token_mac(codec, state) << YK_TOKEN_STATE_BITS;
+  token->bits[0] = (uint64_t) state;
+  token->bits[1] = (uint64_t) (state >> 64);
+  return 1;
+}
+
+/**
+   Restores the state of a game from a token created with
+   `yk_token_encode`, with a codec using the same dictionary and key.
+   The game is scored as if started with `yk_game_init`.
+
+   @param token the token, as handed back by the client.
+
+   @param game the struct where the game state is to be stored.
+
+   @returns a non-zero value if the game was restored, or zero if the
+   token was not signed with the key of the codec or does not hold a
+   valid game (errno is set to EBADMSG).
+ */
+int yk_token_decode(const yk_token_codec_t *codec, const yk_token_t *token, yk_game_t *game) {
+  token_bits_t bits = (token_bits_t) token->bits[1] << 64 | token->bits[0];
+  token_bits_t state = bits & (((token_bits_t) 1 << YK_TOKEN_STATE_BITS) - 1);
+  const uint32_t index_mask = YK_TOKEN_MAX_WORDS - 1;
+
+  if (bits >> YK_TOKEN_STATE_BITS != token_mac(codec, state)) goto invalid;
+  state = token_cipher(codec, state, 1);
+
+  unsigned int num_attempts = state & ((1u << YK_TOKEN_COUNT_BITS) - 1);
+  uint32_t answer = (state >> YK_TOKEN_COUNT_BITS) & index_mask;
+  if (num_attempts > MAX_NUM_ATTEMPTS || answer >= codec->dict->num_words) goto invalid;
+
+  packed_word_t packed_answer = codec->dict->words[answer];
+  game->dict = codec->dict;
+  game->daily = NULL;
+  unpack_word(packed_answer, game->answer);
+  game->num_attempts = num_attempts;
+  game->solved = 0;
+
+  for (unsigned int i = 0; i < MAX_NUM_ATTEMPTS; i++) {
+    uint32_t guess = (state >> (YK_TOKEN_COUNT_BITS + (i + 1) * YK_TOKEN_INDEX_BITS)) & index_mask;
+    if (i >= num_attempts) {
+      if (guess != 0) goto invalid;
+      continue;
+    }
+    if (guess >= codec->dict->num_words || game->solved) goto invalid;
+
+    packed_word_t packed_guess = codec->dict->words[guess];
+    pattern_t pattern = score_word(packed_guess, packed_answer);
+    unpack_word(packed_guess, game->guesses[i]);
+    pattern_to_result(pattern, game->results[i]);
+    game->solved = pattern == PATTERN_SOLVED;
+  }
+  return 1;
+
+ invalid:
+  errno = EBADMSG;
+  return 0;
+}
+
+/**
+   Writes a token as 32 lowercase hexadecimal digits.
+
+   @param text where the token is stored, as a zero-terminated
+   string. Must have space for YK_TOKEN_TEXT_SIZE characters.
+ */
+void yk_token_format(const yk_token_t *token, char text[]) {
+  static const char digits[] = "0123456789abcdef";
+
+  for (int i = 0; i < 32; i++)
+    text[i] = digits[token->bits[1 - i / 16] >> (60 - i % 16 * 4) & 0xf];
+  text[32] = '\0';
+}
+
+/**
+   Reads a token written by `yk_token_format`. Uppercase digits are
+   also accepted.
+
+   @returns a non-zero value if `text` holds exactly 32 hexadecimal
+   digits, or zero otherwise (errno is set to EINVAL).
+ */
+int yk_token_parse(const char text[], yk_token_t *token) {
+  token->bits[0] = token->bits[1] = 0;
+
+  for (int i = 0; i < 32; i++) {
+    char c = text[i];
+    unsigned int digit;
+
+    if (c >= '0' && c <= '9') digit = c - '0';
+    else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+    else goto invalid;
+    token->bits[1 - i / 16] |= (uint64_t) digit << (60 - i % 16 * 4);
+  }
+  if (text[32] == '\0') return 1;
+
+ invalid:
+  errno = EINVAL;
+  return 0;
+}
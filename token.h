@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "engine.h"
+
+/* Bits used by each dictionary index in a token. Dictionaries with
+   more words than fit cannot be used for tokens. */
+#define YK_TOKEN_INDEX_BITS 14
+#define YK_TOKEN_MAX_WORDS (1u << YK_TOKEN_INDEX_BITS)
+
+/* Bits used by the number of attempts in a token. */
+#define YK_TOKEN_COUNT_BITS 3
+
+/* Bits of a token holding the game state: the number of attempts, the
+   answer and MAX_NUM_ATTEMPTS guesses. The rest hold the signature. */
+#define YK_TOKEN_STATE_BITS (YK_TOKEN_COUNT_BITS + (MAX_NUM_ATTEMPTS + 1) * YK_TOKEN_INDEX_BITS)
+#define YK_TOKEN_MAC_BITS (128 - YK_TOKEN_STATE_BITS)
+
+#if MAX_NUM_ATTEMPTS >= (1 << YK_TOKEN_COUNT_BITS) || YK_TOKEN_MAC_BITS < 16
+#error "game state does not fit in a 128-bit token"
+#endif
+
+/* Characters needed to store a token as text, including the
+   terminating zero. */
+#define YK_TOKEN_TEXT_SIZE 33
+
+/** The whole state of a game, encrypted and signed, in 128 bits. The
+    low YK_TOKEN_STATE_BITS hold the number of attempts, then the index
+    of the answer in the dictionary, then the index of each guess
+    (unused guesses are zero), all encrypted with a Feistel permutation
+    keyed with the codec's key. The high YK_TOKEN_MAC_BITS hold a
+    SipHash-2-4 signature of the encrypted state.
+
+    The signature is short: a client can forge a token for some
+    (random) state in about 2^YK_TOKEN_MAC_BITS (2^27) attempts, by
+    submitting made-up tokens until one is accepted. Servers should
+    limit the rate at which each client may submit tokens that fail to
+    decode.
+
+    Tokens also carry no nonce or expiry, and nothing records which
+    ones were used: every token the server ever issued stays valid. A
+    client can resubmit the token it held before a wrong guess, and so
+    take back guesses for as long as it likes. Servers where that
+    matters must bound it themselves, e.g., by keeping the last token
+    issued to each player for the day and rejecting any other, or by
+    allowing each player a fixed number of guesses per day. */
+typedef struct yk_token {
+  uint64_t bits[2];
+} yk_token_t;
+
+typedef struct yk_token_codec {
+
+  /** Dictionary the indices in tokens refer to. */
+  const yk_dict_t *dict;
+
+  /** Secret key used to sign tokens. */
+  uint64_t key[2];
+
+  /** Open-addressed hash table from words to their index in `dict`:
+      each slot holds the packed word shifted left by 32 bits, with the
+      index in the low 32 bits. Empty slots hold zero. */
+  uint64_t *slots;
+
+  /** Number of items in `slots` minus one. */
+  uint32_t mask;
+} yk_token_codec_t;
+
+int yk_token_codec_init(yk_token_codec_t *, const yk_dict_t *, const uint64_t[]);
+void yk_token_codec_free(yk_token_codec_t *);
+
+int yk_token_encode(const yk_token_codec_t *, const yk_game_t *, yk_token_t *);
+int yk_token_decode(const yk_token_codec_t *, const yk_token_t *, yk_game_t *);
+
+void yk_token_format(const yk_token_t *, char[]);
+int yk_token_parse(const char[], yk_token_t *);
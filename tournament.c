@@ -0,0 +1,153 @@
+#include <string.h>
+#include <time.h>
+
+#include "tournament.h"
+#include "parallel.h"
+
+/* Number of games played by each parallel task. */
+#define GAMES_PER_TASK 16
+
+typedef struct tournament {
+  const yk_dict_t *dict;
+  const packed_word_t *answers;
+  unsigned int num_answers;
+  unsigned int num_chunks;
+  tournament_entry_t *entries;
+
+  /* Shared state of each strategy, as returned by its `init`. */
+  void **shared;
+} tournament_t;
+
+/* Processor time used by the calling thread, in nanoseconds. Library
+   functions called by a strategy run inline in this thread (see
+   `yk_strategy_t`), so this is all the time spent on a move. */
+static uint64_t thread_time(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return (uint64_t) now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+/**
+   Plays one game with a strategy.
+
+   @returns the outcome of the game, as expected by `save_stats`, or
+   zero if the game could not be started. `forfeited` is set if the
+   strategy gave up or made an invalid guess.
+ */
+static unsigned int play(tournament_t *tournament, unsigned int entry_index, packed_word_t answer,
+                         int *forfeited) {
+  tournament_entry_t *entry = &tournament->entries[entry_index];
+  const yk_strategy_t *strategy = entry->strategy;
+  unsigned int num_moves = 0;
+  uint64_t total = 0, slowest = 0;
+  char answer_text[WORD_SIZE + 1], guess[WORD_SIZE + 1];
+  letter_result_t result[WORD_SIZE];
+  yk_game_t game;
+
+  unpack_word(answer, answer_text);
+  if (!yk_game_init(&game, tournament->dict, answer_text)) return 0;
+
+  void *state = strategy->new_game(tournament->shared[entry_index]);
+  if (state == NULL) return 0;
+
+  *forfeited = 0;
+  while (!yk_game_finished(&game)) {
+    memset(guess, 0, sizeof(guess));
+
+    uint64_t start = thread_time();
+    int guessed = strategy->next_guess(state, guess);
+    uint64_t elapsed = thread_time() - start;
+
+    num_moves++;
+    total += elapsed;
+    if (elapsed > slowest) slowest = elapsed;
+
+    guess[WORD_SIZE] = '\0';
+    if (!guessed || yk_game_submit(&game, guess, result) == YK_GUESS_INVALID) {
+      *forfeited = 1;
+      break;
+    }
+    strategy->observe(state, guess, result);
+  }
+  strategy->end_game(state);
+
+  __atomic_fetch_add(&entry->num_moves, num_moves, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&entry->move_time, total, __ATOMIC_RELAXED);
+  uint64_t max = __atomic_load_n(&entry->max_move_time, __ATOMIC_RELAXED);
+  while (slowest > max
+         && !__atomic_compare_exchange_n(&entry->max_move_time, &max, slowest, 1,
+                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    ;
+
+  return *forfeited ? MAX_NUM_ATTEMPTS + 1 : yk_game_result(&game);
+}
+
+static void play_chunk(unsigned int task, void *data) {
+  tournament_t *tournament = data;
+  unsigned int entry_index = task / tournament->num_chunks;
+  unsigned int start = task % tournament->num_chunks * GAMES_PER_TASK;
+  unsigned int end = start + GAMES_PER_TASK;
+  tournament_entry_t *entry = &tournament->entries[entry_index];
+
+  if (end > tournament->num_answers) end = tournament->num_answers;
+  if (tournament->shared[entry_index] == NULL) return;
+
+  for (unsigned int i = start; i < end; i++) {
+    int forfeited = 0;
+    unsigned int outcome = play(tournament, entry_index, tournament->answers[i], &forfeited);
+
+    if (outcome == 0) {
+      __atomic_store_n(&entry->failed, 1, __ATOMIC_RELAXED);
+      return;
+    }
+    if (forfeited) __atomic_fetch_add(&entry->num_forfeited, 1, __ATOMIC_RELAXED);
+    if (outcome > MAX_NUM_ATTEMPTS) __atomic_fetch_add(&entry->num_missed_words, 1, __ATOMIC_RELAXED);
+    else __atomic_fetch_add(&entry->wins_per_num_attempts[outcome - 1], 1, __ATOMIC_RELAXED);
+  }
+}
+
+/**
+   Plays every strategy against the same answers, and records the
+   outcome of the games and the time taken by each move. Games are
+   played in parallel, for all strategies at once.
+
+   @param dict the dictionary of valid guesses.
+
+   @param answers the answers of the games played by each strategy.
+   Must be words in `dict`.
+
+   @param num_answers the number of items in `answers`.
+
+   @param entries the strategies to play, with `strategy` set. All
+   other fields are set by this function.
+
+   @param num_entries the number of items in `entries`.
+
+   @returns a non-zero value if every strategy played every game, or
+   zero if any of them failed, in which case its `failed` field is
+   set.
+ */
+int run_tournament(const yk_dict_t *dict, const packed_word_t answers[], unsigned int num_answers,
+                   tournament_entry_t entries[], unsigned int num_entries) {
+  void *shared[num_entries ? num_entries : 1];
+  tournament_t tournament = { .dict = dict, .answers = answers, .num_answers = num_answers,
+                              .num_chunks = (num_answers + GAMES_PER_TASK - 1) / GAMES_PER_TASK,
+                              .entries = entries, .shared = shared };
+  int result = 1;
+
+  for (unsigned int i = 0; i < num_entries; i++) {
+    const yk_strategy_t *strategy = entries[i].strategy;
+    memset(&entries[i], 0, sizeof(entries[i]));
+    entries[i].strategy = strategy;
+    shared[i] = strategy->init(dict);
+    entries[i].failed = shared[i] == NULL;
+  }
+
+  parallel_run(num_entries * tournament.num_chunks, play_chunk, &tournament);
+
+  for (unsigned int i = 0; i < num_entries; i++) {
+    if (shared[i] != NULL) entries[i].strategy->destroy(shared[i]);
+    if (entries[i].failed) result = 0;
+  }
+  return result;
+}
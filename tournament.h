@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "strategy.h"
+
+typedef struct tournament_entry {
+  const yk_strategy_t *strategy;
+
+  /** Number of games won after 1, 2, 3, ... guesses, and number of
+      games lost. */
+  unsigned int wins_per_num_attempts[MAX_NUM_ATTEMPTS];
+  unsigned int num_missed_words;
+
+  /** Number of games lost by giving up or by guessing a word that is
+      not in the dictionary. Included in `num_missed_words`. */
+  unsigned int num_forfeited;
+
+  /** Number of guesses made, and the processor time spent choosing
+      them, in nanoseconds: in total, and for the slowest one. */
+  unsigned int num_moves;
+  uint64_t move_time;
+  uint64_t max_move_time;
+
+  /** Set if the strategy could not be initialized or could not start
+      a game. */
+  int failed;
+} tournament_entry_t;
+
+int run_tournament(const yk_dict_t *, const packed_word_t[], unsigned int, tournament_entry_t[], unsigned int);
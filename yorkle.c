@@ -2,14 +2,39 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/file.h>
+#include <sys/ioctl.h>
+#include <dlfcn.h>
 
 #include "yorkle.h"
+#include "detect.h"
+#include "report.h"
+#include "shard.h"
+#include "matrix.h"
+#include "exact.h"
+#include "book.h"
 
 /* Constants containing information about the files used in game
    mechanics */
 #define WORD_LIST_FILENAME     "words.txt"
 #define TODAYS_ANSWER_FILENAME "answer.txt"
 #define STATS_FILENAME         "stats.txt"
+#define PRIORS_FILENAME        "priors.txt"
+#define HISTORY_FILENAME       "history.log"
+#define CHECKPOINT_FILENAME    "history.ckpt"
+
+/* Bounds on the width of the guess distribution bars, in
+   characters. */
+#define MIN_BAR_WIDTH 10
+#define MAX_BAR_WIDTH 200
+
+/* Number of games logged after the last checkpoint of the history
+   that cause a new checkpoint to be written. */
+#define CHECKPOINT_INTERVAL 64
 
 /* Printf formats to be used for individual characters based on their
    match to the correct answer */
@@ -18,38 +43,45 @@
 #define LETTER_FORMAT_INCORRECT   "\e[40;37m%c\e[0m"
 
 /**
-   Reads the file words.txt and retrieves all words from that
-   file. Updates the entries in `valid_words` according to the data in
-   that file. If the file contains more than MAX_VALID_WORDS words,
-   stops reading after that limit.
+   Reads the file words.txt and loads all words from that file into a
+   game engine dictionary, for play and solving, rather than
+   validation alone.
 
-   @param valid_words a struct where the list of valid words is to be
-   loaded to.
+   @param dict the dictionary to be loaded. Must be released with
+   `yk_dict_free` if this function succeeds.
 
    @returns a non-zero value if the words were successfully loaded, or
    zero if an error happened while attempting to read the file.
 */
-int load_valid_words(valid_word_list_t *valid_words) {
-	FILE *fh;
-	char word[WORD_SIZE + 1];
-	int word_count = 0;
+int load_dictionary(yk_dict_t *dict) {
+	char *buffer = NULL;
+	size_t length = 0, capacity = 0, count;
+	int result;
 
-	fh = fopen(WORD_LIST_FILENAME, "r");
+	FILE *fh = fopen(WORD_LIST_FILENAME, "r");
 	if (fh == NULL) return 0; // file out found error
 
-	while (fscanf(fh, "%s", &word) != EOF) {
-		if (word_count >= MAX_VALID_WORDS) break;
-		for (int i = 0; i < strlen(word); i++) {
-			valid_words->words[word_count][i] = word[i];
+	do {
+		if (length == capacity) {
+			capacity = capacity ? capacity * 2 : 65536;
+			char *grown = realloc(buffer, capacity);
+			if (grown == NULL) {
+				free(buffer);
+				fclose(fh);
+				return 0;
+			}
+			buffer = grown;
 		}
-		valid_words->words[word_count][strlen(word)] = '\0';
-		word_count++;
-	}
-	valid_words->num_words = word_count;
-	
+		count = fread(buffer + length, 1, capacity - length, fh);
+		length += count;
+	} while (count > 0);
+
+	result = !ferror(fh) && yk_dict_load(dict, buffer, length);
+
+	free(buffer);
 	fclose(fh);
 
-	return 1;
+	return result;
 }
 
 /**
@@ -77,6 +109,92 @@ int load_todays_answer(char answer[]) {
 	return 1;
 }
 
+/* Compares sorted dictionary entries by their word, in the high 32
+   bits. */
+static int compare_packed_entries(const void *a, const void *b) {
+	uint32_t x = *(const uint64_t *) a >> 32, y = *(const uint64_t *) b >> 32;
+	return (x > y) - (x < y);
+}
+
+/**
+   Reads the file priors.txt, which gives the weight of words as
+   practice answers, and builds a table to pick answers with those
+   weights. Each line holds a word and its weight, separated by
+   spaces. Words that are not in the dictionary are ignored, and words
+   that are not in the file are never picked.
+
+   @param dict the dictionary the answers are picked from.
+
+   @param table the table to be built. Must be released with
+   `alias_table_free` if this function succeeds.
+
+   @returns a non-zero value if the weights were successfully loaded,
+   or zero if the file could not be read or gives no word a positive
+   weight. If the file does not exist, errno is set to ENOENT.
+ */
+int load_priors(const yk_dict_t *dict, alias_table_t *table) {
+	char word[WORD_SIZE + 2];
+	double weight;
+	int result = 0;
+
+	FILE *fh = fopen(PRIORS_FILENAME, "r");
+	if (fh == NULL) return 0;
+
+	/* Dictionary positions are found by looking up words in a sorted
+	   copy, where the low bits of each entry hold the position. */
+	uint64_t *sorted = malloc((dict->num_words ? dict->num_words : 1) * sizeof(*sorted));
+	double *weights = calloc(dict->num_words ? dict->num_words : 1, sizeof(*weights));
+	if (sorted == NULL || weights == NULL) goto done;
+
+	for (unsigned int i = 0; i < dict->num_words; i++) sorted[i] = (uint64_t) dict->words[i] << 32 | i;
+	qsort(sorted, dict->num_words, sizeof(*sorted), compare_packed_entries);
+
+	while (fscanf(fh, "%6s %lf", word, &weight) == 2) {
+		uint64_t key = (uint64_t) pack_word(word) << 32;
+		uint64_t *found = bsearch(&key, sorted, dict->num_words, sizeof(*sorted), compare_packed_entries);
+		if (found != NULL && strlen(word) == WORD_SIZE && weight > 0) weights[(uint32_t) *found] = weight;
+	}
+
+	result = !ferror(fh) && alias_table_init(table, weights, dict->num_words);
+
+ done:
+	free(sorted);
+	free(weights);
+	fclose(fh);
+	return result;
+}
+
+/**
+   Reads the opening book of the dictionary from book.bin. If the file
+   does not exist, or was computed for another version of words.txt,
+   the book is computed again and saved, which takes a few seconds.
+
+   @param book where the book is stored.
+
+   @returns a non-zero value if the book was read or computed, even if
+   it could not be saved, or zero if it could not be computed.
+ */
+int load_opening_book(const yk_dict_t *dict, opening_book_t *book) {
+  char temporary[sizeof(OPENING_BOOK_FILENAME) + 32];
+
+  if (opening_book_load(book, dict, OPENING_BOOK_FILENAME)) return 1;
+
+  fprintf(stderr, "Computing the opening book for %s...\n", WORD_LIST_FILENAME);
+  if (!opening_book_build(book, dict)) return 0;
+
+  /* Each process writes its own temporary file, so that games started
+     at the same time do not mix their writes. */
+  snprintf(temporary, sizeof(temporary), "%s.%ld.tmp", OPENING_BOOK_FILENAME, (long) getpid());
+  FILE *fh = fopen(temporary, "wb");
+  int saved = fh != NULL && opening_book_write(fh, book);
+  saved = fh != NULL && fclose(fh) == 0 && saved && rename(temporary, OPENING_BOOK_FILENAME) == 0;
+  if (!saved) {
+    perror("Error saving opening book");
+    remove(temporary);
+  }
+  return 1;
+}
+
 /**
    Reads the file stats.txt and retrieves the player's current
    stats. Saves the result in `stats_per_num_attempts` and
@@ -93,30 +211,125 @@ void load_stats(player_stats_t *stats) {
 		for (int i = 0; i < MAX_NUM_ATTEMPTS; i++) stats->wins_per_num_attempts[i] = 0;
 		stats->num_missed_words = 0;
 	} else {
-		printf("I shouldn't be running!");
 		for (int i = 0; i < MAX_NUM_ATTEMPTS; i++) {
-			fscanf(fh, "%d", &value);
-			stats->wins_per_num_attempts[i] = value != EOF ? value : 0;
+			stats->wins_per_num_attempts[i] = fscanf(fh, "%d", &value) == 1 ? value : 0;
 		}
-		fscanf(fh, "%d", &value);
-		stats->num_missed_words = value != EOF ? value : 0;
+		stats->num_missed_words = fscanf(fh, "%d", &value) == 1 ? value : 0;
 
 		fclose(fh);
 	}
 }
 
 /**
-   Reads one guess attempt from the player. A prompt is provided in
-   standard output with the format (replacing 1 with the attempt
-   number):
+   Locks the file stats.txt for exclusive use by this process, waiting
+   for other processes holding the lock to release it. The file is
+   created if it does not exist. Used when several games may finish
+   at the same time, so that reading the current stats with
+   `load_stats` and saving them with `save_stats` is not interleaved
+   with other processes doing the same.
+
+   @returns a file descriptor to be passed to `unlock_stats`, or -1 if
+   the file could not be locked.
+ */
+int lock_stats(void) {
+	int fd = open(STATS_FILENAME, O_RDONLY | O_CREAT, 0644);
+	if (fd < 0) return -1;
+
+	if (flock(fd, LOCK_EX) != 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/**
+   Releases a lock obtained with `lock_stats`.
+ */
+void unlock_stats(int fd) {
+	if (fd >= 0) close(fd);
+}
+
+/* Number of bytes read from standard input at once by `read_word`. */
+#define INPUT_BUFFER_SIZE 65536
+
+/* Number of bytes classified at once when input is read. */
+#define INPUT_LANES 16
+
+typedef uint8_t vinput_t __attribute__((vector_size(INPUT_LANES)));
+typedef int8_t vinput_mask_t __attribute__((vector_size(INPUT_LANES)));
+
+/* Input read from standard input but not yet consumed by `read_word`.
+   Letters are already lowercase, and `spaces` has one bit set for each
+   space-like byte. */
+static struct {
+  uint8_t data[INPUT_BUFFER_SIZE];
+  uint64_t spaces[INPUT_BUFFER_SIZE / 64];
+  size_t position;
+  size_t length;
+} input;
+
+/* Packs the top bit of each byte of `x` into the low 8 bits. */
+static unsigned int byte_mask(uint64_t x) {
+  return ((x & 0x8080808080808080u) * 0x0002040810204081u) >> 56;
+}
+
+/**
+   Reads the next block of standard input into `input`, replacing what
+   was there, and classifies all of it at once: letters are converted
+   to lowercase, and space-like bytes are marked in `input.spaces`.
+
+   @returns a non-zero value if anything was read, or zero at the end
+   of the input or on error.
+ */
+static int fill_input(void) {
+  ssize_t count;
+
+  do {
+    count = read(STDIN_FILENO, input.data, sizeof(input.data));
+  } while (count < 0 && errno == EINTR);
+
+  input.position = 0;
+  input.length = count > 0 ? count : 0;
+  if (count <= 0) return 0;
+
+  /* Padding the last block with non-space bytes keeps the loop free
+     of bounds checks; they are never consumed. */
+  size_t padded = (input.length + INPUT_LANES - 1) / INPUT_LANES * INPUT_LANES;
+  memset(input.data + input.length, 'x', padded - input.length);
+  memset(input.spaces, 0, sizeof(input.spaces));
+
+  for (size_t start = 0; start < padded; start += INPUT_LANES) {
+    vinput_t bytes;
+    uint64_t halves[2];
+
+    memcpy(&bytes, input.data + start, sizeof(bytes));
+    vinput_mask_t upper = (vinput_mask_t) (bytes - 'A' < 26);
+    vinput_mask_t space = (vinput_mask_t) (bytes == ' ') | (vinput_mask_t) (bytes - '\t' <= '\r' - '\t');
+    bytes += (vinput_t) upper & ('a' - 'A');
+    memcpy(input.data + start, &bytes, sizeof(bytes));
+
+    memcpy(halves, &space, sizeof(halves));
+    uint64_t bits = byte_mask(halves[0]) | byte_mask(halves[1]) << 8;
+    input.spaces[start / 64] |= bits << (start % 64);
+  }
+  return 1;
+}
+
+/* Checks if the byte at `position` of the input is space-like. */
+static int input_is_space(size_t position) {
+  return input.spaces[position / 64] >> (position % 64) & 1;
+}
+
+/**
+   Reads one guess attempt from the player. If standard input is a
+   terminal, a prompt is provided in standard output with the format
+   (replacing 1 with the attempt number):
     
        Attempt #1: 
 
    A space is included at the end of the prompt, but not a line
-   break. At most WORD_SIZE characters are read, up to a space-like
-   character (space, tab, line break, etc.). Spaces at the start of
-   the input are ignored. Any characters read from the user are
-   converted to lowercase before returning.
+   break. When input is piped, no prompt is printed. The attempt is
+   then read as described in `read_word`.
     
    @param num_attempt the attempt number, to be used in the prompt.
 
@@ -130,138 +343,74 @@ void load_stats(player_stats_t *stats) {
    (e.g., EOF).
  */
 int read_attempt(unsigned int num_attempt, char attempt[]) {
-	printf("Attempt #%d: ", num_attempt);
+	static int interactive = -1;
+
+	if (interactive < 0) interactive = isatty(STDIN_FILENO);
+	if (interactive) {
+		printf("Attempt #%d: ", num_attempt);
+		fflush(stdout);
+	}
 
-	char current_char;
-	int numCharsRead = 0;
+	return read_word(attempt);
+}
 
+/**
+   Reads one word from standard input, without a prompt. At most
+   WORD_SIZE characters are read, up to a space-like character (space,
+   tab, line break, etc.). Spaces at the start of the input are
+   ignored. Any characters read are converted to lowercase before
+   returning.
+
+   Standard input is read directly, in large blocks, and each block is
+   classified at once, so that piped input with many words is read
+   quickly. It must not also be read through `stdin`.
+
+   @param word an array of characters where the word is to be stored,
+   as a zero-terminated string. Must have space for at least
+   WORD_SIZE+1 characters.
+
+   @returns a non-zero value if the word was successfully read, or
+   zero if an error happened while attempting to read it (e.g., EOF).
+ */
+int read_word(char word[]) {
+	int i = 0;
+
+	/* Skip spaces, a whole 64-byte word of the bitmap at a time. */
 	for (;;) {
-		current_char = getchar();
-		if (current_char == EOF) return 0; // error in reading attempt
-		else if (!isspace(current_char)) {
-			current_char = tolower(current_char);
-			attempt[0] = current_char;
-			break;
+		if (input.position == input.length && !fill_input()) return 0;
+
+		uint64_t bits = ~input.spaces[input.position / 64] >> (input.position % 64);
+		if (bits == 0) {
+			input.position = (input.position / 64 + 1) * 64;
+			if (input.position > input.length) input.position = input.length;
+			continue;
 		}
+		input.position += __builtin_ctzll(bits);
+		if (input.position < input.length) break;
+		input.position = input.length;
 	}
 
-	int i;
-	for (i = 1; i < WORD_SIZE; i++) {
-		current_char = getchar();
-		if (isspace(current_char)) break;
-		current_char = tolower(current_char);
-		attempt[i] = current_char;
+	while (i < WORD_SIZE) {
+		if (input.position == input.length && !fill_input()) break;
+		if (input_is_space(input.position++)) break;
+		word[i++] = input.data[input.position - 1];
 	}
-	attempt[i] = '\0';
+	word[i] = '\0';
 
 	return 1;
 }
 
 /**
-   Checks if the attempt is a valid guess word, based on
-   `valid_words`. If (and only if) it is not a valid word, prints an
-   error message to standard error with the format (replacing `xxxxx`
-   with the attempt word), followed by a line break:
+   Prints an error message to standard error reporting that the attempt
+   is not a valid word, with the format (replacing `xxxxx` with the
+   attempt word), followed by a line break:
 
        'xxxxx' is not a valid word.
 
-   @param valid_words a struct where the list of valid words is stored.
-
    @param attempt the word guessed by the player.
-
-   @returns a non-zero value if the attempt is a valid word according
-   to the list of accepted words, or zero otherwise.
  */
-int attempt_is_valid(const valid_word_list_t *valid_words, const char attempt[]) {
-  if (strlen(attempt) != WORD_SIZE) {
-    fprintf(stderr, "'%s' is not a valid word.\n", attempt);
-    return 0;
-  }
-
-  for (int i = 0; i < valid_words->num_words; i++) {
-    if (strcmp(valid_words->words[i], attempt) == 0) {
-      return 1;
-    }
-  }
-
+void print_invalid_attempt(const char attempt[]) {
   fprintf(stderr, "'%s' is not a valid word.\n", attempt);
-  return 0;
-}
-
-/**
-   Compares the guessed word with the correct answer, completing the
-   result array according to the expected values:
-    
-   - If the letter at position i of the guess matches the
-     corresponding letter in the same position in the answer, then
-     `result[i]` is set to LR_IN_PLACE;
-
-   - If the letter at position i of the guess matches some letter in
-     the answer, but at a different position, then `result[i]` is set
-     to LR_WRONG_PLACE;
-
-   - If none of the matches above are correct, `result[i] is set to
-     LR_INCORRECT.
-
-   Note that, if the guess or answer have repeated letters,
-   LR_IN_PLACE takes precedence if there is a match, and
-   LR_WRONG_PLACE may only be used if the corresponding letter in the
-   answer must not have been matched with another letter in the guess.
-
-   Example: if the answer is `bread` and the guess is `erase`, index 1
-   gets LR_IN_PLACE (R matches), indices 0 and 2 get LR_WRONG_PLACE (E
-   and A are in the answer), index 3 gets LR_INCORRECT (there is no S)
-   and index 4 gets LR_INCORRECT (there is an E, but it is matched by
-   index 0).
-
-   Another example: if the answer is `blood`, and the guess is
-   `boron`, indices 0 and 3 get LR_IN_PLACE (B and the last O match),
-   LR_WRONG_PLACE in index 1 (there is another unmatched O in the
-   answer, but not at this position) and LR_INCORRECT in indices 2 and
-   4 (since there is no R or N in the answer).
-
-   @param todays_answer the answer to be compared against the guessed
-   attempt.
-
-   @param attempt the word guessed by the player.
-   
-   @param result an array where the results of each letter are
-   stored. Must have space for WORD_SIZE elements.
-
-   @returns a non-zero value if all letters match with LR_IN_PLACE,
-   and zero otherwise. The result is always updated, regardless of the
-   return value.
- */
-int compare_result(const char todays_answer[], const char attempt[], letter_result_t result[]) {
-  int out = 1; // non-zero value indicates correct attempt and 0 otherwise
-
-  // make a copy of todays_answer
-  char todays_answer_copy[WORD_SIZE];
-  for (int i = 0; i < WORD_SIZE; i++) {
-    todays_answer_copy[i] = todays_answer[i];
-  }
-
-  for (int i = 0; i < WORD_SIZE; i++) {
-    if (attempt[i] == todays_answer[i]) {
-      result[i] = LR_IN_PLACE;
-      todays_answer_copy[i] = '!';
-    } else {
-      out = 0;
-      result[i] = LR_INCORRECT;
-    }
-  }  
-
-  for (int i = 0; i < WORD_SIZE; i++) {
-    for (int j = 0; j < WORD_SIZE; j++) {
-      if (attempt[i] == todays_answer_copy[j] && result[i] != 2) {
-        result[i] = LR_WRONG_PLACE;
-        todays_answer_copy[j] = '!';
-        break;
-      }
-    }
-  }
-
-  return out;
 }
 
 /**
@@ -290,6 +439,28 @@ void print_attempt_result(const char attempt[], const letter_result_t result[])
   printf("\n");
 }
 
+/**
+   Saves stats to the stats.txt file, replacing what was there.
+
+   @param stats the stats to be saved.
+
+   @returns a non-zero value if the stats were successfully saved to
+   the file, or zero if an error happened while attempting to write to
+   the file.
+ */
+int write_stats(const player_stats_t *stats) {
+  FILE *fh = fopen(STATS_FILENAME, "w");
+  if (fh == NULL) return 0;
+
+  for (int i = 0; i < MAX_NUM_ATTEMPTS; i++) {
+    fprintf(fh, "%u ", stats->wins_per_num_attempts[i]);
+  }
+
+  fprintf(fh, "%u\n", stats->num_missed_words);
+
+  return fclose(fh) == 0;
+}
+
 /**
    Updates the stats according to the latest results, and saves the
    new stats to the stats.txt file.
@@ -312,25 +483,109 @@ int save_stats(player_stats_t *stats, unsigned int num_attempts) {
     stats->wins_per_num_attempts[num_attempts-1]++;
   }
 
-  FILE *fh = fopen(STATS_FILENAME, "w");
+  return write_stats(stats);
+}
 
-  for (int i = 0; i < MAX_NUM_ATTEMPTS; i++) {
-    fprintf(fh, "%u ", stats->wins_per_num_attempts[i]);
-  }
+/**
+   @returns the number of columns of the terminal, from the terminal
+   itself if standard output is one, or else from the COLUMNS
+   environment variable, or 80 if neither is known.
+ */
+static unsigned int terminal_width(void) {
+  struct winsize size;
+  const char *columns = getenv("COLUMNS");
+
+  if (isatty(STDOUT_FILENO) && ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0)
+    return size.ws_col;
+  if (columns != NULL && atoi(columns) > 0) return atoi(columns);
+  return 80;
+}
 
-  fprintf(fh, "%u\n", stats->num_missed_words);
+/**
+   Checks if bars can be drawn with Unicode block characters: standard
+   output must be a terminal, and the locale must use UTF-8.
+ */
+static int unicode_bars(void) {
+  const char *locale = getenv("LC_ALL");
 
-  fclose(fh);
-  return 1;
+  if (locale == NULL || *locale == '\0') locale = getenv("LC_CTYPE");
+  if (locale == NULL || *locale == '\0') locale = getenv("LANG");
+  if (locale == NULL || !isatty(STDOUT_FILENO)) return 0;
+  return strstr(locale, "UTF-8") != NULL || strstr(locale, "utf8") != NULL;
+}
+
+/**
+   Prints the guess distribution part of the stats, with one bar per
+   number of attempts. While every bar fits in the terminal, each win
+   is drawn as one `*`. Otherwise, the bars are scaled so that the
+   longest one fills the terminal, and drawn with Unicode blocks down
+   to an eighth of a character if the terminal supports them (see
+   `unicode_bars`); a bar for a non-zero count is never empty. The
+   output is built in a single buffer and written at once, so the time
+   taken only depends on the terminal width, whatever the counts.
+
+   @param counts the number of wins for each number of attempts.
+
+   @param size the number of items in `counts`.
+ */
+static void print_distribution(const unsigned int counts[], int size) {
+  /* Each bar character takes up to 3 bytes in UTF-8. */
+  char buffer[MAX_NUM_ATTEMPTS * (3 * MAX_BAR_WIDTH + 32) + 32];
+  unsigned int max = 0, width;
+  int length = 0, unicode = 0, digits;
+
+  for (int i = 0; i < size; i++)
+    if (counts[i] > max) max = counts[i];
+
+  digits = snprintf(NULL, 0, "%u", max);
+  width = terminal_width();
+  width = width > (unsigned int) digits + 5 ? width - digits - 5 : 0;
+  if (width < MIN_BAR_WIDTH) width = MIN_BAR_WIDTH;
+  if (width > MAX_BAR_WIDTH) width = MAX_BAR_WIDTH;
+  if (max > width) unicode = unicode_bars();
+
+  length += sprintf(buffer + length, "Guess distribution:\n");
+  for (int i = 0; i < size; i++) {
+    /* Length of the bar in eighths of a character. */
+    uint64_t eighths = max <= width ? 8 * (uint64_t) counts[i] : 8 * (uint64_t) counts[i] * width / max;
+    if (!unicode) eighths &= ~(uint64_t) 7;
+    if (counts[i] > 0 && eighths == 0) eighths = unicode ? 1 : 8;
+
+    length += sprintf(buffer + length, "%d: ", i + 1);
+    for (uint64_t j = 0; j < eighths / 8; j++) {
+      if (unicode) {
+        memcpy(buffer + length, "\u2588", 3);
+        length += 3;
+      } else {
+        buffer[length++] = '*';
+      }
+    }
+    if (eighths % 8 != 0) {
+      /* U+2589 to U+258F are blocks of 7 eighths down to 1 eighth. */
+      buffer[length++] = '\xe2';
+      buffer[length++] = '\x96';
+      buffer[length++] = (char) (0x90 - eighths % 8);
+    }
+    if (eighths > 0) buffer[length++] = ' ';
+    length += sprintf(buffer + length, "%u\n", counts[i]);
+  }
+
+  fwrite(buffer, 1, length, stdout);
 }
 
 /**
    Prints the currently loaded stats to standard output. The format
    follows the one in the following example, adjusting for proper
-   values:
+   values. The streaks and recent games are only shown if
+   `stats->history` is set, and take constant time to compute. Bars
+   longer than the terminal allows are scaled, as described in
+   `print_distribution`:
 
 Played: 57
 Win %: 96.5%
+Current streak: 4
+Max streak: 19
+Last 30 days: 25 played, 92.0% won
 
 Guess distribution:
 1: 0
@@ -353,15 +608,742 @@ void print_stats(const player_stats_t *stats) {
   int games = wins + stats->num_missed_words;
   printf("Played: %d\n", games);
   double winRate = 100.0 * wins / games;
-  printf("Win %%: %.1lf%%\n\n", winRate);
-  printf("Guess distribution:\n");
+  printf("Win %%: %.1lf%%\n", winRate);
+
+  if (stats->history != NULL) {
+    unsigned int recent_wins, recent_games = history_recent(stats->history, today(), &recent_wins);
+    printf("Current streak: %u\n", stats->history->current_streak);
+    printf("Max streak: %u\n", stats->history->max_streak);
+    printf("Last %d days: %u played", HISTORY_WINDOW_DAYS, recent_games);
+    if (recent_games > 0) printf(", %.1lf%% won", 100.0 * recent_wins / recent_games);
+    printf("\n");
+  }
+  printf("\n");
+  print_distribution(stats->wins_per_num_attempts, size);
+}
 
-  for (int i = 0; i < size; i++) {
-    printf("%d: ", i+1);
-    for (int j = 1; j <= stats->wins_per_num_attempts[i]; j++) {
-      if (j == stats->wins_per_num_attempts[i]) printf("* ");
-      else printf("*");
+/**
+   @returns the current day, in local time, as the number of days since
+   1970-01-01.
+ */
+int32_t today(void) {
+  time_t now = time(NULL);
+  struct tm local;
+
+  localtime_r(&now, &local);
+  return (now + local.tm_gmtoff) / 86400;
+}
+
+/**
+   Loads the player's history: the summary in history.ckpt, and then
+   the games in history.log after that summary was written. Each line
+   of the log has one game: the day it was played (see `today`), the
+   answer and the outcome, as expected by `save_stats`. Since a new
+   summary is written every CHECKPOINT_INTERVAL games, loading never
+   reads more than that many games from the log. If neither file
+   exists, the history is empty.
+
+   @param history the struct to be initialized. Must be released with
+   `history_free` if this function succeeds.
+
+   @param num_unsaved where the number of games read from the log is
+   stored, to be passed to `save_history`.
+
+   @returns a non-zero value if the history was loaded, or zero if the
+   files could not be read or are not valid.
+ */
+int load_history(history_t *history, unsigned int *num_unsaved) {
+  long offset = 0;
+  int32_t day;
+  char answer[WORD_SIZE + 2];
+  unsigned int outcome;
+
+  *num_unsaved = 0;
+
+  FILE *fh = fopen(CHECKPOINT_FILENAME, "r");
+  if (fh != NULL) {
+    int read = fscanf(fh, "offset %ld ", &offset) == 1 && history_read(fh, history);
+    fclose(fh);
+    if (!read) return 0;
+  } else if (!history_init(history)) {
+    return 0;
+  }
+
+  fh = fopen(HISTORY_FILENAME, "r");
+  if (fh == NULL) return 1;
+  if (fseek(fh, offset, SEEK_SET) != 0) goto invalid;
+
+  while (fscanf(fh, "%d %6s %u", &day, answer, &outcome) == 3) {
+    if (strlen(answer) != WORD_SIZE || !history_add(history, day, pack_word(answer), outcome)) goto invalid;
+    (*num_unsaved)++;
+  }
+  if (!feof(fh)) goto invalid;
+
+  fclose(fh);
+  return 1;
+
+ invalid:
+  fclose(fh);
+  history_free(history);
+  return 0;
+}
+
+/**
+   Adds a finished game to the player's history, and appends it to
+   history.log. When the log has CHECKPOINT_INTERVAL games after the
+   last summary, a new summary is written to history.ckpt. The stats
+   should be locked with `lock_stats`, and the history loaded again
+   with `load_history`, so that games finished by other processes are
+   included.
+
+   @param history the history, as loaded by `load_history`.
+
+   @param num_unsaved the number of games in the log after the last
+   summary, as set by `load_history`.
+
+   @param answer the answer of the game.
+
+   @param num_attempts the outcome of the game, as expected by
+   `save_stats`.
+
+   @returns a non-zero value if the game was saved, or zero if an error
+   happened.
+ */
+int save_history(history_t *history, unsigned int num_unsaved, const char answer[], unsigned int num_attempts) {
+  uint64_t counts[MAX_NUM_ATTEMPTS + 1] = { 0 };
+
+  counts[num_attempts - 1] = 1;
+  return save_history_games(history, &num_unsaved, today(), answer, counts);
+}
+
+/**
+   Writes a summary of the history to history.ckpt, for the games in
+   history.log up to `offset`. Written to a temporary file first, so
+   that readers never see a partial summary.
+ */
+static int write_checkpoint(const history_t *history, long offset) {
+  FILE *fh = fopen(CHECKPOINT_FILENAME ".tmp", "w");
+  if (fh == NULL) return 0;
+  fprintf(fh, "offset %ld\n", offset);
+  int written = history_write(fh, history);
+  if (fclose(fh) != 0 || !written) return 0;
+  return rename(CHECKPOINT_FILENAME ".tmp", CHECKPOINT_FILENAME) == 0;
+}
+
+/**
+   Same as `save_history`, for any number of games played on one day
+   with one answer, so that the history is loaded once for all of
+   them. Games are logged in order of outcome.
+
+   @param num_unsaved the number of games in the log after the last
+   summary, as set by `load_history`. Updated as games are added.
+
+   @param day the day the games were played, as given by `today`.
+
+   @param counts the number of games with each outcome, indexed by the
+   outcome minus one (MAX_NUM_ATTEMPTS+1 elements).
+ */
+int save_history_games(history_t *history, unsigned int *num_unsaved, int32_t day, const char answer[],
+                       const uint64_t counts[]) {
+  packed_word_t packed = pack_word(answer);
+
+  FILE *fh = fopen(HISTORY_FILENAME, "a");
+  if (fh == NULL) return 0;
+
+  for (unsigned int outcome = 1; outcome <= MAX_NUM_ATTEMPTS + 1; outcome++) {
+    for (uint64_t i = 0; i < counts[outcome - 1]; i++) {
+      if (!history_add(history, day, packed, outcome)) goto failed;
+      fprintf(fh, "%d %s %u\n", day, answer, outcome);
+
+      if (++*num_unsaved < CHECKPOINT_INTERVAL) continue;
+      long offset = fflush(fh) == 0 ? ftell(fh) : -1;
+      if (offset < 0 || !write_checkpoint(history, offset)) goto failed;
+      *num_unsaved = 0;
     }
-    printf("%d\n", stats->wins_per_num_attempts[i]);
   }
+  return fclose(fh) == 0;
+
+ failed:
+  fclose(fh);
+  return 0;
+}
+
+/**
+   Prints how often the answer of a game has been played before, if
+   it has, for example:
+
+'bread' was the answer in 2 of your games, 2 of them won.
+Last time, on 2026-09-30, you found it in 4 guesses.
+
+   @param history the player's history, not including the game just
+   played.
+
+   @param answer the answer of the game.
+ */
+void print_answer_history(const history_t *history, const char answer[]) {
+  const answer_history_t *entry = history_answer(history, pack_word(answer));
+  char date[16];
+  time_t when;
+
+  if (entry == NULL) return;
+
+  when = (time_t) entry->last_day * 86400;
+  strftime(date, sizeof(date), "%Y-%m-%d", gmtime(&when));
+
+  printf("'%s' was the answer in %u of your games, %u of them won.\n", answer, entry->num_games, entry->num_wins);
+  if (entry->last_outcome > MAX_NUM_ATTEMPTS)
+    printf("Last time, on %s, you did not find it.\n\n", date);
+  else
+    printf("Last time, on %s, you found it in %u guess%s.\n\n", date, entry->last_outcome,
+           entry->last_outcome == 1 ? "" : "es");
+}
+
+/**
+   Prints the analysis of the guesses made in a game to standard
+   output, one line per guess, in the following format:
+
+Analysis:
+Guess  Before  After   Bits  Expected  Best   Expected
+crane   14855     43   8.43      5.33  tares       6.16
+bludy      43      1   5.43      2.61  atlas       3.79
+bread       1      1   0.00      0.00  bread       0.00
+
+   @param analysis the analysis of each guess, as set by
+   `analyze_game`.
+
+   @param num_guesses the number of items in `analysis`.
+ */
+void print_analysis(const guess_analysis_t analysis[], unsigned int num_guesses) {
+  char guess[WORD_SIZE + 1], best[WORD_SIZE + 1];
+
+  printf("Analysis:\n");
+  printf("Guess  Before  After   Bits  Expected  Best   Expected\n");
+
+  for (unsigned int i = 0; i < num_guesses; i++) {
+    unpack_word(analysis[i].guess, guess);
+    unpack_word(analysis[i].best_guess, best);
+    printf("%s  %6u %6u %6.2lf %9.2lf  %s %10.2lf\n", guess,
+           analysis[i].candidates_before, analysis[i].candidates_after,
+           analysis[i].bits_gained, analysis[i].expected_bits,
+           best, analysis[i].best_expected_bits);
+  }
+  printf("\n");
+}
+
+/**
+   Prints a hint to standard output, followed by a line break. The
+   format depends on the type of hint, e.g.:
+
+       Hint: 43 words may still be the answer.
+       Hint: the answer contains the letter 'e'.
+       Hint: the best next guess is 'atlas'.
+
+   @param hint the hint to be printed, as set by `hint_next`.
+ */
+void print_hint(const hint_t *hint) {
+  switch (hint->type) {
+  case HINT_NUM_CANDIDATES:
+    if (hint->num_candidates == 1) printf("Hint: only one word may still be the answer.\n");
+    else printf("Hint: %u words may still be the answer.\n", hint->num_candidates);
+    break;
+  case HINT_LETTER:
+    printf("Hint: the answer contains the letter '%c'.\n", hint->letter);
+    break;
+  case HINT_BEST_GUESS:
+    printf("Hint: the best next guess is '%s'.\n", hint->guess);
+    break;
+  }
+}
+
+static int compare_scores(const void *a, const void *b) {
+  double score_a = player_score(*(const player_record_t **) a);
+  double score_b = player_score(*(const player_record_t **) b);
+  return (score_a < score_b) - (score_a > score_b);
+}
+
+/**
+   Reads a log of finished games and prints the players whose guesses
+   are statistically implausible for someone who does not know the
+   answer. Each line of the log has one game: the player name, the
+   answer and the guesses, in order, separated by spaces. Lines that
+   are empty or start with `#` are ignored. Lines without an answer
+   and 1 to MAX_NUM_ATTEMPTS guesses, and games with a word that is not
+   in the dictionary, are skipped, and how many there are of each is
+   printed along with the first line of each kind. Flagged players are
+   printed in the following format, most suspicious first:
+
+Player               Games  Excess bits  Score
+mallory                 20        87.42  12.81
+
+   Excess bits is the information gained by the player's guesses,
+   beyond what was expected from them, over all games. Score is the
+   number of standard deviations the excess is above zero. Players
+   scoring at least DETECT_THRESHOLD are flagged.
+
+   @param dict the dictionary used in the games.
+
+   @param filename the name of the log file, or `-` for standard input.
+
+   @returns a non-zero value if the log was read, or zero if an error
+   happened while reading it.
+ */
+int print_suspicious_players(const yk_dict_t *dict, const char filename[]) {
+  detector_t detector;
+  char *line = NULL;
+  size_t line_size = 0;
+  unsigned int num_games = 0, num_flagged = 0, line_number = 0;
+  unsigned int num_malformed = 0, first_malformed = 0, num_invalid = 0, first_invalid = 0;
+  int result = 0;
+
+  FILE *fh = strcmp(filename, "-") == 0 ? stdin : fopen(filename, "r");
+  if (fh == NULL) return 0;
+  if (!detector_init(&detector, dict)) goto done;
+
+  while (getline(&line, &line_size, fh) != -1) {
+    const char *fields[MAX_NUM_ATTEMPTS + 2];
+    unsigned int num_fields = 0;
+
+    line_number++;
+    for (char *field = strtok(line, " \t\r\n"); field != NULL; field = strtok(NULL, " \t\r\n")) {
+      /* Extra fields are counted, not stored, so the line is not
+         mistaken for a shorter game. */
+      if (num_fields < MAX_NUM_ATTEMPTS + 2) fields[num_fields] = field;
+      num_fields++;
+    }
+    if (num_fields == 0 || fields[0][0] == '#') continue;
+
+    if (num_fields < 3 || num_fields > MAX_NUM_ATTEMPTS + 2) {
+      if (num_malformed++ == 0) first_malformed = line_number;
+      continue;
+    }
+
+    int added = detector_add_game(&detector, fields[0], fields[1], fields + 2, num_fields - 2);
+    if (added < 0) goto done;
+    if (added) num_games++;
+    else if (num_invalid++ == 0) first_invalid = line_number;
+  }
+  if (ferror(fh)) goto done;
+
+  const player_record_t **flagged = malloc((detector.num_players + 1) * sizeof(*flagged));
+  if (flagged == NULL) goto done;
+  for (unsigned int i = 0; i < detector.capacity; i++) {
+    const player_record_t *record = &detector.players[i];
+    if (record->name != NULL && player_score(record) >= DETECT_THRESHOLD) flagged[num_flagged++] = record;
+  }
+  qsort(flagged, num_flagged, sizeof(*flagged), compare_scores);
+
+  printf("Read %u games from %u players.\n", num_games, detector.num_players);
+  if (num_malformed > 0)
+    printf("Skipped %u lines without an answer and 1 to %d guesses (first at line %u).\n", num_malformed,
+           MAX_NUM_ATTEMPTS, first_malformed);
+  if (num_invalid > 0)
+    printf("Skipped %u lines with words not in the word list (first at line %u).\n", num_invalid, first_invalid);
+  printf("\n");
+  printf("Player               Games  Excess bits  Score\n");
+  for (unsigned int i = 0; i < num_flagged; i++)
+    printf("%-20s %5u %12.2lf %6.2lf\n", flagged[i]->name, flagged[i]->num_games,
+           flagged[i]->excess_bits, player_score(flagged[i]));
+
+  free(flagged);
+  result = 1;
+
+ done:
+  if (detector.players != NULL) detector_free(&detector);
+  free(line);
+  if (fh != stdin) fclose(fh);
+  return result;
+}
+
+/**
+   Computes a quality report of every word in the dictionary and
+   writes it to a file, one row per word: how the word splits the
+   dictionary as a guess, and how many guesses the solver needs when
+   it is the answer. The rows are written as CSV, or in binary as
+   described in `report_write_binary`.
+
+   @param dict the dictionary to report on.
+
+   @param filename the name of the file to write, or "-" for standard
+   output.
+
+   @param binary non-zero to write binary rows instead of CSV.
+
+   @returns a non-zero value if the report was written, or zero if an
+   error happened.
+ */
+int write_report(const yk_dict_t *dict, const char filename[], int binary) {
+  word_report_t *rows = calloc(dict->num_words ? dict->num_words : 1, sizeof(*rows));
+  int result = 0;
+
+  if (rows == NULL) return 0;
+  if (!build_report(dict, rows)) goto done;
+
+  FILE *fh = strcmp(filename, "-") == 0 ? stdout : fopen(filename, binary ? "wb" : "w");
+  if (fh == NULL) goto done;
+
+  if (binary) result = report_write_binary(fh, rows, dict->num_words);
+  else result = report_write_csv(fh, rows, dict->num_words);
+
+  if (fh == stdout) result = fflush(fh) == 0 && result;
+  else result = fclose(fh) == 0 && result;
+
+ done:
+  free(rows);
+  return result;
+}
+
+/**
+   Computes one shard of the quality report written by `write_report`
+   and writes it as a partial report, to be combined with the other
+   shards by yorkle-merge. Shards can be computed by separate
+   processes, on any hosts that have the same word list.
+
+   @param dict the dictionary to report on.
+
+   @param filename the name of the file to write, or "-" for standard
+   output.
+
+   @param shard the index of the shard, from 0 to `num_shards - 1`.
+
+   @param num_shards the number of shards the report is split into.
+
+   @returns a non-zero value if the partial report was written, or zero
+   if an error happened.
+ */
+int write_partial_report(const yk_dict_t *dict, const char filename[], unsigned int shard, unsigned int num_shards) {
+  shard_header_t header = { .dict_hash = yk_dict_hash(dict), .shard = shard,
+                            .num_shards = num_shards, .num_words = dict->num_words };
+  unsigned int first, end;
+  int result = 0;
+
+  shard_range(dict->num_words, shard, num_shards, &first, &end);
+  header.first = first;
+  header.num_rows = end - first;
+
+  word_report_t *rows = calloc(end > first ? end - first : 1, sizeof(*rows));
+  if (rows == NULL) return 0;
+  if (!build_report_range(dict, first, end, rows)) goto done;
+
+  FILE *fh = strcmp(filename, "-") == 0 ? stdout : fopen(filename, "wb");
+  if (fh == NULL) goto done;
+
+  result = shard_write(fh, &header, rows);
+  if (fh == stdout) result = fflush(fh) == 0 && result;
+  else result = fclose(fh) == 0 && result;
+
+ done:
+  free(rows);
+  return result;
+}
+
+/**
+   Brings the cached pattern matrix in a file up to date with the
+   dictionary, creating it if it does not exist, and prints how much
+   of it could be reused, for example:
+
+Pattern matrix: 14855 words, 14831 reused, 24 scored in 61 ms
+
+   The matrix is written to a temporary file first, so that readers
+   never see a partial matrix.
+
+   @param dict the current dictionary.
+
+   @param filename the name of the file holding the matrix.
+
+   @returns a non-zero value if the matrix was updated, or zero if an
+   error happened.
+ */
+int update_matrix(const yk_dict_t *dict, const char filename[]) {
+  pattern_matrix_t matrix;
+  unsigned int num_reused;
+  struct timespec start, end;
+  char temporary[4096];
+
+  if (snprintf(temporary, sizeof(temporary), "%s.tmp", filename) >= (int) sizeof(temporary)) {
+    errno = ENAMETOOLONG;
+    return 0;
+  }
+
+  FILE *fh = fopen(filename, "rb");
+  if (fh == NULL && errno != ENOENT) return 0;
+  if (fh == NULL) {
+    pattern_matrix_init(&matrix);
+  } else {
+    int read = pattern_matrix_read(fh, &matrix);
+    fclose(fh);
+    if (!read) {
+      fprintf(stderr, "Ignoring invalid pattern matrix in %s\n", filename);
+      pattern_matrix_init(&matrix);
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  int result = pattern_matrix_update(&matrix, dict, &num_reused);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  if (!result) goto done;
+
+  printf("Pattern matrix: %u words, %u reused, %u scored in %.0f ms\n", matrix.num_words, num_reused,
+         matrix.num_words - num_reused, (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6);
+
+  fh = fopen(temporary, "wb");
+  if (fh == NULL) {
+    result = 0;
+    goto done;
+  }
+  result = pattern_matrix_write(fh, &matrix);
+  result = fclose(fh) == 0 && result && rename(temporary, filename) == 0;
+
+ done:
+  pattern_matrix_free(&matrix);
+  return result;
+}
+
+/**
+   Computes the strategy that finds the answers of a pool with the
+   fewest guesses on average, any valid word being allowed as a guess,
+   and prints it: a summary line starting with #, then, for every
+   answer, the guesses played until it is found.
+
+   @param filename the path of the pool: words separated by white
+   space. Repeated words are counted once.
+
+   @returns a non-zero value on success, or zero if the pool could not
+   be read, is too large or has an invalid word (errno is set to
+   EINVAL), or memory could not be allocated.
+ */
+int print_exact_strategy(const yk_dict_t *dict, const char filename[]) {
+  char word[WORD_SIZE + 2];
+  packed_word_t *pool = NULL;
+  unsigned int num_answers = 0, capacity = 0;
+  exact_strategy_t strategy;
+  word_set_t seen;
+  struct timespec start, end;
+  int result = 0;
+
+  FILE *fh = fopen(filename, "r");
+  if (fh == NULL) return 0;
+  if (!word_set_init(&seen)) {
+    fclose(fh);
+    return 0;
+  }
+
+  while (fscanf(fh, "%6s", word) == 1) {
+    packed_word_t packed = pack_word(word);
+    if (!yk_dict_contains(dict, word)) {
+      fprintf(stderr, "Not a valid word: %s\n", word);
+      errno = EINVAL;
+      goto done;
+    }
+    if (word_set_contains(&seen, packed)) continue;
+    word_set_add(&seen, packed);
+
+    if (num_answers == capacity) {
+      capacity = capacity ? 2 * capacity : 256;
+      packed_word_t *grown = realloc(pool, capacity * sizeof(*pool));
+      if (grown == NULL) goto done;
+      pool = grown;
+    }
+    pool[num_answers++] = packed;
+  }
+  if (ferror(fh)) goto done;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  if (!exact_solve(dict->words, dict->num_words, pool, num_answers, &strategy)) goto done;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  unsigned int most = 0;
+  for (unsigned int i = 0; i < num_answers; i++)
+    if (strategy.num_guesses[i] > most) most = strategy.num_guesses[i];
+  printf("# %u answers, %llu guesses, %.4f on average, at most %u; %llu sets searched in %.1f s\n",
+         num_answers, (unsigned long long) strategy.total_guesses,
+         num_answers ? (double) strategy.total_guesses / num_answers : 0.0, most,
+         (unsigned long long) strategy.num_nodes,
+         (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+  result = exact_write_strategy(stdout, &strategy);
+  exact_strategy_free(&strategy);
+
+ done:
+  word_set_free(&seen);
+  free(pool);
+  fclose(fh);
+  return result;
+}
+
+/**
+   Loads a strategy plugin: a shared object exporting a function named
+   YK_STRATEGY_SYMBOL, as described in `yk_strategy_t`. The shared
+   object stays loaded until the program exits.
+
+   @param filename the path of the shared object. Paths without a
+   slash are looked up by the dynamic linker, so plugins in the current
+   directory must be given as, e.g., ./strategy_entropy.so.
+
+   @returns the strategy, or NULL if it could not be loaded, in which
+   case the reason is printed to standard error.
+ */
+const yk_strategy_t *load_strategy(const char filename[]) {
+  void *handle = dlopen(filename, RTLD_NOW | RTLD_LOCAL);
+  if (handle == NULL) {
+    fprintf(stderr, "%s\n", dlerror());
+    return NULL;
+  }
+
+  yk_strategy_entry_t entry;
+  *(void **) &entry = dlsym(handle, YK_STRATEGY_SYMBOL);
+  const yk_strategy_t *strategy = entry != NULL ? entry() : NULL;
+
+  if (strategy == NULL || strategy->version != YK_STRATEGY_VERSION) {
+    fprintf(stderr, "%s: not a strategy plugin for this version\n", filename);
+    dlclose(handle);
+    return NULL;
+  }
+  return strategy;
+}
+
+/**
+   Prints the results of a tournament to standard output: for each
+   strategy, its name, its stats in the format of `print_stats`, and
+   the processor time spent per move, for example:
+
+Strategy: entropy
+Played: 100
+...
+Moves: 389, 15750.3 us per move on average, 154680.0 us at most
+Forfeited: 0
+
+   @param entries the strategies, as set by `run_tournament`.
+
+   @param num_entries the number of items in `entries`.
+ */
+void print_tournament(const tournament_entry_t entries[], unsigned int num_entries) {
+  for (unsigned int i = 0; i < num_entries; i++) {
+    const tournament_entry_t *entry = &entries[i];
+    player_stats_t stats = { .history = NULL };
+
+    memcpy(stats.wins_per_num_attempts, entry->wins_per_num_attempts, sizeof(stats.wins_per_num_attempts));
+    stats.num_missed_words = entry->num_missed_words;
+
+    printf("Strategy: %s%s\n", entry->strategy->name, entry->failed ? " (failed)" : "");
+    print_stats(&stats);
+    printf("Moves: %u, %.1lf us per move on average, %.1lf us at most\n", entry->num_moves,
+           entry->num_moves ? entry->move_time / 1e3 / entry->num_moves : 0, entry->max_move_time / 1e3);
+    printf("Forfeited: %u\n\n", entry->num_forfeited);
+  }
+}
+
+/* Longest line printed by `print_json_guess` or `print_json_finished`:
+   the fixed text, plus up to 6 characters per byte of an escaped
+   guess and 10 digits per number. */
+#define JSON_LINE_SIZE 160
+
+/* Appends text to a JSON line being built, returning the new length. */
+static size_t json_append(char line[], size_t length, const char text[]) {
+  size_t size = strlen(text);
+  memcpy(line + length, text, size);
+  return length + size;
+}
+
+/* Appends a number to a JSON line being built, returning the new
+   length. */
+static size_t json_append_number(char line[], size_t length, unsigned int value) {
+  char digits[10];
+  int count = 0;
+
+  do {
+    digits[count++] = '0' + value % 10;
+    value /= 10;
+  } while (value > 0);
+  while (count > 0) line[length++] = digits[--count];
+  return length;
+}
+
+/* Appends a string to a JSON line being built, in quotes and escaped
+   as needed, returning the new length. Bytes that are not printable
+   ASCII are escaped as `\u00XX`, so the line is always valid. */
+static size_t json_append_string(char line[], size_t length, const char text[]) {
+  static const char hex[] = "0123456789abcdef";
+
+  line[length++] = '"';
+  for (const unsigned char *c = (const unsigned char *) text; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\') {
+      line[length++] = '\\';
+      line[length++] = *c;
+    } else if (*c < 0x20 || *c >= 0x7f) {
+      length = json_append(line, length, "\\u00");
+      line[length++] = hex[*c >> 4];
+      line[length++] = hex[*c & 0xf];
+    } else {
+      line[length++] = *c;
+    }
+  }
+  line[length++] = '"';
+  return length;
+}
+
+/**
+   Prints the outcome of a guess to standard output as one line of
+   JSON, for automated clients, for example:
+
+{"guess":"crane","pattern":19,"valid":true,"attempts_left":5,"candidates":43}
+{"guess":"xyzzy","pattern":null,"valid":false,"attempts_left":5,"candidates":43}
+
+   The line is built in a buffer on the stack, without allocating
+   memory, and written at once.
+
+   @param guess the word guessed by the player.
+
+   @param result the result of the guess, as set by `compare_result`,
+   or NULL if the guess is not a valid word.
+
+   @param attempts_left the number of attempts left after the guess.
+
+   @param num_candidates the number of words that may still be the
+   answer after the guess.
+ */
+void print_json_guess(const char guess[], const letter_result_t result[], unsigned int attempts_left,
+                      unsigned int num_candidates) {
+  char line[JSON_LINE_SIZE];
+  size_t length = 0;
+
+  length = json_append(line, length, "{\"guess\":");
+  length = json_append_string(line, length, guess);
+  length = json_append(line, length, ",\"pattern\":");
+  if (result != NULL) length = json_append_number(line, length, pattern_from_result(result));
+  else length = json_append(line, length, "null");
+  length = json_append(line, length, result != NULL ? ",\"valid\":true" : ",\"valid\":false");
+  length = json_append(line, length, ",\"attempts_left\":");
+  length = json_append_number(line, length, attempts_left);
+  length = json_append(line, length, ",\"candidates\":");
+  length = json_append_number(line, length, num_candidates);
+  length = json_append(line, length, "}\n");
+
+  fwrite(line, 1, length, stdout);
+  fflush(stdout);
+}
+
+/**
+   Prints the end of a game to standard output as one line of JSON,
+   in the same way as `print_json_guess`, for example:
+
+{"finished":true,"solved":true,"attempts":3,"answer":"bread"}
+
+   @param outcome the result of the game, as expected by `save_stats`.
+
+   @param answer the answer of the game.
+ */
+void print_json_finished(unsigned int outcome, const char answer[]) {
+  char line[JSON_LINE_SIZE];
+  size_t length = 0;
+  int solved = outcome <= MAX_NUM_ATTEMPTS;
+
+  length = json_append(line, length, solved ? "{\"finished\":true,\"solved\":true"
+                                            : "{\"finished\":true,\"solved\":false");
+  length = json_append(line, length, ",\"attempts\":");
+  length = json_append_number(line, length, solved ? outcome : MAX_NUM_ATTEMPTS);
+  length = json_append(line, length, ",\"answer\":");
+  length = json_append_string(line, length, answer);
+  length = json_append(line, length, "}\n");
+
+  fwrite(line, 1, length, stdout);
+  fflush(stdout);
 }
@@ -1,24 +1,14 @@
 #pragma once
 
-#define WORD_SIZE 5
-#define MAX_NUM_ATTEMPTS 6
-#define MAX_VALID_WORDS 20000
+#include "engine.h"
+#include "analysis.h"
+#include "hint.h"
+#include "practice.h"
+#include "tournament.h"
+#include "history.h"
 
-typedef enum {
-  LR_INCORRECT = 0,
-  LR_WRONG_PLACE,
-  LR_IN_PLACE
-} letter_result_t;
-
-typedef struct valid_word_list {
-
-  /** Array containing a list of all words accepted as guesses in the
-      game. Only the first `num_words` words are considered. */
-  char words[MAX_VALID_WORDS][WORD_SIZE + 1];
-
-  /** Number of items in `words` that correspond to a valid word. */
-  unsigned int num_words;
-} valid_word_list_t;
+/* Attempt entered by the player to ask for a hint. */
+#define HINT_COMMAND "?"
 
 typedef struct player_stats {
   /** Number of games in which the player has correctly guessed the
@@ -30,17 +20,46 @@ typedef struct player_stats {
   /** Number of games in which the player was unable to guess the
       correct word even after MAX_NUM_ATTEMPTS guesses. */
   unsigned int num_missed_words;
+
+  /** Streaks, recent games and games per answer, or NULL if they are
+      not shown. */
+  const history_t *history;
 } player_stats_t;
 
-int load_valid_words(valid_word_list_t *);
+int load_dictionary(yk_dict_t *);
 int load_todays_answer(char[]);
+int load_opening_book(const yk_dict_t *, opening_book_t *);
+int load_priors(const yk_dict_t *, alias_table_t *);
 
 int read_attempt(unsigned int, char[]);
-int attempt_is_valid(const valid_word_list_t *, const char[]);
+int read_word(char[]);
+void print_invalid_attempt(const char[]);
 
-int compare_result(const char[], const char[], letter_result_t[]);
 void print_attempt_result(const char[], const letter_result_t[]);
 
 void load_stats(player_stats_t *);
+int lock_stats(void);
+void unlock_stats(int);
 int save_stats(player_stats_t *, unsigned int);
+int write_stats(const player_stats_t *);
 void print_stats(const player_stats_t *);
+
+int32_t today(void);
+int load_history(history_t *, unsigned int *);
+int save_history(history_t *, unsigned int, const char[], unsigned int);
+int save_history_games(history_t *, unsigned int *, int32_t, const char[], const uint64_t[]);
+void print_answer_history(const history_t *, const char[]);
+
+void print_analysis(const guess_analysis_t[], unsigned int);
+void print_hint(const hint_t *);
+int print_suspicious_players(const yk_dict_t *, const char[]);
+int write_report(const yk_dict_t *, const char[], int);
+int write_partial_report(const yk_dict_t *, const char[], unsigned int, unsigned int);
+int update_matrix(const yk_dict_t *, const char[]);
+int print_exact_strategy(const yk_dict_t *, const char[]);
+
+const yk_strategy_t *load_strategy(const char[]);
+void print_tournament(const tournament_entry_t[], unsigned int);
+
+void print_json_guess(const char[], const letter_result_t[], unsigned int, unsigned int);
+void print_json_finished(unsigned int, const char[]);
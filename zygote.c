@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "zygote.h"
+
+/* Set when the parent is asked to stop with SIGINT or SIGTERM. */
+static volatile sig_atomic_t stopping;
+
+static void stop(int signal) {
+  (void) signal;
+  stopping = 1;
+}
+
+/**
+   Runs in a pre-forked child: waits for a connection, tells the parent
+   it was taken by writing its process id, so that a replacement can
+   be forked, and runs the session with the connection as standard
+   input, output and error. Never returns.
+ */
+static void serve_one(int listen_fd, int notify_fd, pid_t parent, zygote_session_t session, void *data) {
+  int conn;
+
+  signal(SIGINT, SIG_DFL);
+  signal(SIGTERM, SIG_DFL);
+
+  /* Children still waiting when the parent stops are not needed. */
+  prctl(PR_SET_PDEATHSIG, SIGTERM);
+
+  /* The parent may have died before the signal was requested, in which
+     case it will never be sent. */
+  if (getppid() != parent) _exit(0);
+  do {
+    conn = accept(listen_fd, NULL, NULL);
+  } while (conn < 0 && errno == EINTR);
+  prctl(PR_SET_PDEATHSIG, 0);
+
+  pid_t taken = getpid();
+  if (write(notify_fd, &taken, sizeof(taken)) != sizeof(taken)) _exit(1);
+  close(notify_fd);
+  close(listen_fd);
+
+  if (conn < 0) _exit(1);
+
+  if (dup2(conn, STDIN_FILENO) < 0 || dup2(conn, STDOUT_FILENO) < 0 || dup2(conn, STDERR_FILENO) < 0)
+    _exit(1);
+  close(conn);
+
+  int status = session(data);
+  fflush(stdout);
+  _exit(status);
+}
+
+/**
+   Forks a child that waits for one connection.
+
+   @returns the process id of the child, or zero if it could not be
+   created.
+ */
+static pid_t spawn_child(int listen_fd, int notify_pipe[], zygote_session_t session, void *data) {
+  /* Anything still buffered would otherwise be written again by the
+     child. */
+  fflush(stdout);
+  fflush(stderr);
+
+  pid_t parent = getpid();
+  pid_t pid = fork();
+  if (pid < 0) return 0;
+  if (pid == 0) {
+    close(notify_pipe[0]);
+    serve_one(listen_fd, notify_pipe[1], parent, session, data);
+  }
+  return pid;
+}
+
+/**
+   @returns the slot of a child in the pool, or -1 if it is not there.
+ */
+static int find_child(const pid_t pool[], pid_t pid) {
+  for (int i = 0; i < ZYGOTE_POOL_SIZE; i++)
+    if (pool[i] == pid) return i;
+  return -1;
+}
+
+/**
+   Stops the children still waiting for a connection, and waits for
+   them to exit. Children running a session are left to finish it.
+
+   @param pool the process ids of the waiting children, zero for none.
+
+   @param notify_fd the end of the pipe where children report taking
+   a connection, or -1 if there is none.
+ */
+static void stop_children(pid_t pool[], int notify_fd) {
+  struct pollfd notify = { .fd = notify_fd, .events = POLLIN };
+  pid_t taken;
+
+  /* Children that took a connection since the last notification was
+     read are running a session. */
+  while (notify_fd >= 0 && poll(&notify, 1, 0) > 0 && read(notify_fd, &taken, sizeof(taken)) == sizeof(taken)) {
+    int slot = find_child(pool, taken);
+    if (slot >= 0) pool[slot] = 0;
+  }
+
+  /* Waiting children must not be reaped automatically, or their ids
+     could be reused before they are waited for. */
+  signal(SIGCHLD, SIG_DFL);
+  for (int i = 0; i < ZYGOTE_POOL_SIZE; i++) {
+    if (pool[i] == 0) continue;
+    kill(pool[i], SIGTERM);
+    while (waitpid(pool[i], NULL, 0) < 0 && errno == EINTR);
+    pool[i] = 0;
+  }
+}
+
+/**
+   Serves one game session per connection on a Unix domain socket,
+   each in its own process. Everything loaded by the caller before
+   calling this function (dictionary, answer, stats) is shared with
+   the children copy-on-write, so sessions do not pay for loading
+   it. ZYGOTE_POOL_SIZE children are forked in advance and block
+   waiting for a connection; whenever one of them takes a connection,
+   the parent forks a replacement. A session therefore starts as soon
+   as the connection is accepted, without waiting for a fork.
+
+   @param socket_path the path where the socket is to be created. Any
+   existing file at this path is removed.
+
+   @param session function run in the child for each connection.
+
+   @param tick function run in the parent every ZYGOTE_TICK_SECONDS
+   and when the server stops. May be NULL.
+
+   @param data value passed to `session` and `tick`.
+
+   @returns a non-zero value once the server is stopped with SIGINT or
+   SIGTERM, or zero if the socket could not be created or a child
+   could not be forked. Either way, the children still waiting for a
+   connection are stopped and the socket is removed.
+ */
+int run_zygote(const char socket_path[], zygote_session_t session, zygote_tick_t tick, void *data) {
+  struct sockaddr_un addr = { .sun_family = AF_UNIX };
+  int notify_pipe[2] = { -1, -1 };
+  pid_t pool[ZYGOTE_POOL_SIZE] = { 0 };
+  int bound = 0, stopped = 0;
+
+  if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+    errno = ENAMETOOLONG;
+    return 0;
+  }
+  strcpy(addr.sun_path, socket_path);
+
+  int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0) return 0;
+
+  unlink(socket_path);
+  if (bind(listen_fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) goto done;
+  bound = 1;
+  if (listen(listen_fd, SOMAXCONN) != 0 || pipe(notify_pipe) != 0) goto done;
+
+  /* Finished children are reaped automatically. */
+  signal(SIGCHLD, SIG_IGN);
+  signal(SIGINT, stop);
+  signal(SIGTERM, stop);
+
+  for (int i = 0; i < ZYGOTE_POOL_SIZE; i++)
+    if ((pool[i] = spawn_child(listen_fd, notify_pipe, session, data)) == 0) goto done;
+
+  time_t next_tick = time(NULL) + ZYGOTE_TICK_SECONDS;
+  struct pollfd notify = { .fd = notify_pipe[0], .events = POLLIN };
+
+  while (!stopping) {
+    time_t now = time(NULL);
+    if (now >= next_tick) {
+      if (tick != NULL) tick(data);
+      next_tick = now + ZYGOTE_TICK_SECONDS;
+    }
+
+    int ready = poll(&notify, 1, (next_tick - now) * 1000);
+    if (ready < 0 && errno == EINTR) continue;
+    if (ready < 0) goto done;
+    if (ready == 0) continue;
+
+    pid_t taken;
+    ssize_t count = read(notify_pipe[0], &taken, sizeof(taken));
+    if (count < 0 && errno == EINTR) continue;
+    if (count != sizeof(taken)) goto done;
+
+    int slot = find_child(pool, taken);
+    if (slot < 0) continue;
+    pool[slot] = 0;
+    while ((pool[slot] = spawn_child(listen_fd, notify_pipe, session, data)) == 0) {
+      if (errno != EAGAIN) goto done;
+      sleep(1);
+    }
+  }
+
+  if (tick != NULL) tick(data);
+  stopped = 1;
+
+done:;
+  int saved_errno = errno;
+  stop_children(pool, notify_pipe[0]);
+  close(listen_fd);
+  if (notify_pipe[0] >= 0) {
+    close(notify_pipe[0]);
+    close(notify_pipe[1]);
+  }
+  if (bound) unlink(socket_path);
+  errno = saved_errno;
+  return stopped;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+/* Number of pre-forked children waiting for a connection at any
+   time. */
+#define ZYGOTE_POOL_SIZE 4
+
+/* Number of seconds between calls to the tick function in the
+   parent. */
+#define ZYGOTE_TICK_SECONDS 5
+
+/**
+   Function run in a child process for each connection. Standard
+   input, output and error are connected to the client. The return
+   value is used as the exit status of the child.
+ */
+typedef int (*zygote_session_t)(void *data);
+
+/**
+   Function run in the parent process every ZYGOTE_TICK_SECONDS, and
+   once more when the server is stopped, e.g., to save what the
+   sessions have done.
+ */
+typedef void (*zygote_tick_t)(void *data);
+
+int run_zygote(const char[], zygote_session_t, zygote_tick_t, void *);